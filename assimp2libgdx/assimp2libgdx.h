@@ -0,0 +1,87 @@
+/*
+Assimp2Libgdx
+Copyright (c) 2017, Eugene Wang
+
+Licensed under a 3-clause BSD license. See the LICENSE file for more information.
+*/
+
+#ifndef INCLUDED_ASSIMP2LIBGDX
+#define INCLUDED_ASSIMP2LIBGDX
+
+// ----------------------------------------------------------------------------
+// Entry points of the g3dj exporter, for programs which link the converter
+// library instead of running assimp2libgdx.
+//
+// All of them are reentrant and may be called concurrently from any number
+// of threads. The exporter keeps no state between calls: every call works on
+// its own copy of the scene, with its own worker threads, and the only data
+// shared between calls is constant. Calls must not share an IOSystem which
+// isn't thread-safe itself (assimp's DefaultIOSystem is), or a scene which is
+// exported in place.
+//
+// Diagnostics go to assimp's DefaultLogger, which is process wide: create or
+// kill it only while no export runs. Conversion stages are reported to the
+// ConversionStats installed for the calling thread, if any.
+// ----------------------------------------------------------------------------
+
+#include <assimp/Exporter.hpp>
+
+#include <string>
+#include <vector>
+
+#include "export_options.h"
+
+struct aiScene;
+
+namespace Assimp {
+	class IOSystem;
+}
+
+// ---------------------------------------------------------------------------
+/** A file written by Assimp2LibgdxExportToBuffer() */
+struct Assimp2LibgdxFile
+{
+	std::string name;
+	std::vector<char> data;
+};
+
+// ---------------------------------------------------------------------------
+/** Writes scene to file. Embedded textures are written next to it.
+ * @param scene The scene to export, it isn't modified
+ * @param file Path of the g3dj file
+ * @param io IOSystem used to create all files, NULL for assimp's DefaultIOSystem
+ * @param options Options of the export
+ * @throw std::runtime_error if the options are invalid or a file can't be opened
+ */
+void Assimp2LibgdxExport(const aiScene* scene, const char* file, Assimp::IOSystem* io, const Assimp2LibgdxOptions& options);
+
+// ---------------------------------------------------------------------------
+/** Like Assimp2LibgdxExport(), but exports scene in place instead of copying
+ * it first, and takes ownership of it. Meshes are written last, each one
+ * flushed and freed as soon as it is written, so the output never piles up
+ * in memory.
+ */
+void Assimp2LibgdxExportInPlace(aiScene* scene, const char* file, Assimp::IOSystem* io, const Assimp2LibgdxOptions& options);
+
+// ---------------------------------------------------------------------------
+/** Writes scene into memory.
+ * @param scene The scene to export, it isn't modified
+ * @param options Options of the export
+ * @param json Receives the g3dj text
+ * @param textures If not NULL, receives the embedded textures, named as
+ *   the g3dj text refers to them. Otherwise they are dropped.
+ * @throw std::runtime_error if the options are invalid
+ */
+void Assimp2LibgdxExportToBuffer(const aiScene* scene, const Assimp2LibgdxOptions& options, std::string& json,
+	std::vector<Assimp2LibgdxFile>* textures = nullptr);
+
+// ---------------------------------------------------------------------------
+/** The exporter for registration with an Assimp::Exporter, as format
+ * "g3dj". It takes its options from the ExportProperties passed to
+ * Assimp::Exporter::Export(). Failures are thrown as DeadlyExportError,
+ * so the Exporter reports them as AI_FAILURE, with the reason in
+ * GetErrorString().
+ */
+extern const Assimp::Exporter::ExportFormatEntry Assimp2Libgdx_desc;
+
+#endif // INCLUDED_ASSIMP2LIBGDX
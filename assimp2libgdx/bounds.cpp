@@ -0,0 +1,187 @@
+/*
+Assimp2Libgdx
+Copyright (c) 2017, Eugene Wang
+
+Licensed under a 3-clause BSD license. See the LICENSE file for more information.
+*/
+
+#include "bounds.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if !defined(ASSIMP_DOUBLE_PRECISION) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#	define A2L_BOUNDS_SSE
+#	include <emmintrin.h>
+#endif
+
+namespace {
+
+#ifdef A2L_BOUNDS_SSE
+// ------------------------------------------------------------------------------------------------
+// Loads four packed xyz positions as x, y and z of four lanes each
+inline void LoadPositions(const float* p, __m128& x, __m128& y, __m128& z)
+{
+	const __m128 v0 = _mm_loadu_ps(p);     // x0 y0 z0 x1
+	const __m128 v1 = _mm_loadu_ps(p + 4); // y1 z1 x2 y2
+	const __m128 v2 = _mm_loadu_ps(p + 8); // z2 x3 y3 z3
+	const __m128 xy = _mm_shuffle_ps(v1, v2, _MM_SHUFFLE(2, 1, 3, 2)); // x2 y2 x3 y3
+	const __m128 yz = _mm_shuffle_ps(v0, v1, _MM_SHUFFLE(1, 0, 2, 1)); // y0 z0 y1 z1
+	x = _mm_shuffle_ps(v0, xy, _MM_SHUFFLE(2, 0, 3, 0));
+	y = _mm_shuffle_ps(yz, xy, _MM_SHUFFLE(3, 1, 2, 0));
+	z = _mm_shuffle_ps(yz, v2, _MM_SHUFFLE(3, 0, 3, 1));
+}
+
+// ------------------------------------------------------------------------------------------------
+inline float HorizontalMin(__m128 v)
+{
+	v = _mm_min_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+	v = _mm_min_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+	return _mm_cvtss_f32(v);
+}
+
+// ------------------------------------------------------------------------------------------------
+inline float HorizontalMax(__m128 v)
+{
+	v = _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+	v = _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+	return _mm_cvtss_f32(v);
+}
+#endif
+
+// ------------------------------------------------------------------------------------------------
+inline float DistanceSquared(const aiVector3D& a, const aiVector3D& b)
+{
+	const aiVector3D d = a - b;
+	return d.x * d.x + d.y * d.y + d.z * d.z;
+}
+
+} // namespace
+
+// ------------------------------------------------------------------------------------------------
+Bounds :: Bounds()
+	: min(std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max())
+	, max(-std::numeric_limits<float>::max(), -std::numeric_limits<float>::max(), -std::numeric_limits<float>::max())
+	, radius(0.0f)
+{
+}
+
+// ------------------------------------------------------------------------------------------------
+void Bounds :: Add(const Bounds& other)
+{
+	if (other.IsEmpty()) {
+		return;
+	}
+	min = aiVector3D(std::min(min.x, other.min.x), std::min(min.y, other.min.y), std::min(min.z, other.min.z));
+	max = aiVector3D(std::max(max.x, other.max.x), std::max(max.y, other.max.y), std::max(max.z, other.max.z));
+	radius = (max - min).Length() * 0.5f;
+}
+
+// ------------------------------------------------------------------------------------------------
+Bounds ComputeBounds(const aiVector3D* positions, unsigned int count)
+{
+	Bounds bounds;
+	if (!count) {
+		return bounds;
+	}
+
+	unsigned int i = 0;
+#ifdef A2L_BOUNDS_SSE
+	// positions are packed, 4 of them take three loads
+	static_assert(sizeof(aiVector3D) == 3 * sizeof(float), "positions must be packed floats");
+	const float* const p = &positions[0].x;
+	if (count >= 4) {
+		__m128 minX, minY, minZ;
+		LoadPositions(p, minX, minY, minZ);
+		__m128 maxX = minX, maxY = minY, maxZ = minZ;
+		for (i = 4; i + 4 <= count; i += 4) {
+			__m128 x, y, z;
+			LoadPositions(p + i * 3, x, y, z);
+			minX = _mm_min_ps(minX, x);
+			minY = _mm_min_ps(minY, y);
+			minZ = _mm_min_ps(minZ, z);
+			maxX = _mm_max_ps(maxX, x);
+			maxY = _mm_max_ps(maxY, y);
+			maxZ = _mm_max_ps(maxZ, z);
+		}
+		bounds.min = aiVector3D(HorizontalMin(minX), HorizontalMin(minY), HorizontalMin(minZ));
+		bounds.max = aiVector3D(HorizontalMax(maxX), HorizontalMax(maxY), HorizontalMax(maxZ));
+	}
+#endif
+	for (; i < count; ++i) {
+		const aiVector3D& v = positions[i];
+		bounds.min = aiVector3D(std::min(bounds.min.x, v.x), std::min(bounds.min.y, v.y), std::min(bounds.min.z, v.z));
+		bounds.max = aiVector3D(std::max(bounds.max.x, v.x), std::max(bounds.max.y, v.y), std::max(bounds.max.z, v.z));
+	}
+
+	// the sphere needs the center, so it takes a second pass
+	const aiVector3D center = bounds.Center();
+	float radiusSquared = 0.0f;
+	i = 0;
+#ifdef A2L_BOUNDS_SSE
+	if (count >= 4) {
+		const __m128 cx = _mm_set1_ps(center.x), cy = _mm_set1_ps(center.y), cz = _mm_set1_ps(center.z);
+		__m128 farthest = _mm_setzero_ps();
+		for (; i + 4 <= count; i += 4) {
+			__m128 x, y, z;
+			LoadPositions(p + i * 3, x, y, z);
+			x = _mm_sub_ps(x, cx);
+			y = _mm_sub_ps(y, cy);
+			z = _mm_sub_ps(z, cz);
+			const __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+			farthest = _mm_max_ps(farthest, d);
+		}
+		radiusSquared = HorizontalMax(farthest);
+	}
+#endif
+	for (; i < count; ++i) {
+		radiusSquared = std::max(radiusSquared, DistanceSquared(positions[i], center));
+	}
+	bounds.radius = std::sqrt(radiusSquared);
+	return bounds;
+}
+
+// ------------------------------------------------------------------------------------------------
+Bounds ComputeBounds(const aiVector3D* positions, const unsigned int* indices, unsigned int count)
+{
+	Bounds bounds;
+	for (unsigned int i = 0; i < count; ++i) {
+		const aiVector3D& v = positions[indices[i]];
+		bounds.min = aiVector3D(std::min(bounds.min.x, v.x), std::min(bounds.min.y, v.y), std::min(bounds.min.z, v.z));
+		bounds.max = aiVector3D(std::max(bounds.max.x, v.x), std::max(bounds.max.y, v.y), std::max(bounds.max.z, v.z));
+	}
+	const aiVector3D center = bounds.Center();
+	float radiusSquared = 0.0f;
+	for (unsigned int i = 0; i < count; ++i) {
+		radiusSquared = std::max(radiusSquared, DistanceSquared(positions[indices[i]], center));
+	}
+	bounds.radius = std::sqrt(radiusSquared);
+	return bounds;
+}
+
+// ------------------------------------------------------------------------------------------------
+Bounds TransformBounds(const Bounds& bounds, const aiMatrix4x4& m)
+{
+	if (bounds.IsEmpty()) {
+		return bounds;
+	}
+
+	// the transformed center, plus the extents projected onto every axis
+	const aiVector3D c = bounds.Center();
+	const aiVector3D e = (bounds.max - bounds.min) * 0.5f;
+	const aiVector3D center(
+		m.a1 * c.x + m.a2 * c.y + m.a3 * c.z + m.a4,
+		m.b1 * c.x + m.b2 * c.y + m.b3 * c.z + m.b4,
+		m.c1 * c.x + m.c2 * c.y + m.c3 * c.z + m.c4);
+	const aiVector3D extents(
+		std::fabs(m.a1) * e.x + std::fabs(m.a2) * e.y + std::fabs(m.a3) * e.z,
+		std::fabs(m.b1) * e.x + std::fabs(m.b2) * e.y + std::fabs(m.b3) * e.z,
+		std::fabs(m.c1) * e.x + std::fabs(m.c2) * e.y + std::fabs(m.c3) * e.z);
+
+	Bounds transformed;
+	transformed.min = center - extents;
+	transformed.max = center + extents;
+	transformed.radius = extents.Length();
+	return transformed;
+}
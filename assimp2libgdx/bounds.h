@@ -0,0 +1,60 @@
+/*
+Assimp2Libgdx
+Copyright (c) 2017, Eugene Wang
+
+Licensed under a 3-clause BSD license. See the LICENSE file for more information.
+*/
+
+#ifndef INCLUDED_BOUNDS
+#define INCLUDED_BOUNDS
+
+// ----------------------------------------------------------------------------
+// Bounding volumes written along with mesh parts and nodes, so the runtime
+// can cull without scanning vertices at load time.
+// ----------------------------------------------------------------------------
+
+#include <assimp/types.h>
+
+// ---------------------------------------------------------------------------
+/** Axis aligned bounding box, along with a bounding sphere around its
+ *  center. A default constructed box is empty.
+ */
+struct Bounds
+{
+	Bounds();
+
+	bool IsEmpty() const {
+		return min.x > max.x;
+	}
+
+	aiVector3D Center() const {
+		return (min + max) * 0.5f;
+	}
+
+	// -------------------------------------------------------------------
+	/** Grows the box to contain another one. The sphere becomes the one
+	 * around the box. */
+	void Add(const Bounds& other);
+
+	aiVector3D min, max;
+	float radius;
+};
+
+// ---------------------------------------------------------------------------
+/** Bounds of an array of positions. The sphere is centered on the box and
+ *  just large enough for the positions, which is tighter than the sphere
+ *  around the box. Uses SSE where available.
+ */
+Bounds ComputeBounds(const aiVector3D* positions, unsigned int count);
+
+// ---------------------------------------------------------------------------
+/** Bounds of the positions selected by indices, for parts which only use
+ *  some vertices of their mesh. */
+Bounds ComputeBounds(const aiVector3D* positions, const unsigned int* indices, unsigned int count);
+
+// ---------------------------------------------------------------------------
+/** Box around a box after a transformation, with the sphere around that
+ *  box. */
+Bounds TransformBounds(const Bounds& bounds, const aiMatrix4x4& transform);
+
+#endif // INCLUDED_BOUNDS
@@ -0,0 +1,91 @@
+/*
+Assimp2Libgdx
+Copyright (c) 2017, Eugene Wang
+
+Licensed under a 3-clause BSD license. See the LICENSE file for more information.
+*/
+
+#ifndef INCLUDED_CONTENT_HASH
+#define INCLUDED_CONTENT_HASH
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// ---------------------------------------------------------------------------
+/** Incremental 64 bit FNV-1a hash. Not cryptographically secure, but good 
+ *  enough to tell files apart by their content.
+ */
+class ContentHash
+{
+public:
+
+	ContentHash() : value(14695981039346656037ULL) {
+	}
+
+	void Update(const void* data, size_t size) {
+		const unsigned char* bytes = static_cast<const unsigned char*>(data);
+		for (size_t i = 0; i < size; ++i) {
+			value ^= bytes[i];
+			value *= 1099511628211ULL;
+		}
+	}
+
+	void Update(const std::string& s) {
+		// include the length, so that consecutive strings can't run into each other
+		const uint64_t length = s.size();
+		Update(&length, sizeof(length));
+		Update(s.data(), s.size());
+	}
+
+	uint64_t Value() const {
+		return value;
+	}
+
+	// 16 lowercase hex digits
+	std::string HexDigest() const {
+		static const char digits[] = "0123456789abcdef";
+		std::string s(16, '0');
+		for (unsigned int i = 0; i < 16; ++i) {
+			s[15 - i] = digits[(value >> (i * 4)) & 0xf];
+		}
+		return s;
+	}
+
+private:
+
+	uint64_t value;
+};
+
+// ---------------------------------------------------------------------------
+/** Incremental SHA-256, for files that are told apart by their hash alone,
+ *  where an accidental collision of ContentHash would go unnoticed.
+ */
+class Sha256
+{
+public:
+
+	Sha256();
+
+	void Update(const void* data, size_t size);
+
+	void Update(const std::string& s) {
+		// include the length, so that consecutive strings can't run into each other
+		const uint64_t length = s.size();
+		Update(&length, sizeof(length));
+		Update(s.data(), s.size());
+	}
+
+	// 64 lowercase hex digits, of everything passed to Update() so far
+	std::string HexDigest() const;
+
+private:
+
+	void Transform(const unsigned char* block);
+
+	uint32_t state[8];
+	unsigned char buffer[64];
+	uint64_t length; // bytes hashed so far
+};
+
+#endif // INCLUDED_CONTENT_HASH
@@ -0,0 +1,308 @@
+/*
+Assimp2Libgdx
+Copyright (c) 2017, Eugene Wang
+
+Licensed under a 3-clause BSD license. See the LICENSE file for more information.
+*/
+
+#include "conversion_cache.h"
+#include "content_hash.h"
+
+#include <assimp/DefaultLogger.hpp>
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#ifdef _WIN32
+#	include <direct.h>
+#	include <process.h>
+#else
+#	include <sys/stat.h>
+#	include <unistd.h>
+#endif
+
+namespace {
+
+const char* const ManifestHeader = "assimp2libgdx cache 2";
+const char* const MainOutputName = "*";
+
+// ------------------------------------------------------------------------------------------------
+// Cached outputs are named by this hash alone, so it has to be one which doesn't collide
+bool HashFile(const std::string& path, std::string& digest)
+{
+	std::ifstream file(path.c_str(), std::ios::binary);
+	if (!file) {
+		return false;
+	}
+	Sha256 hash;
+	std::vector<char> buffer(1 << 16);
+	while (file) {
+		file.read(&buffer[0], buffer.size());
+		hash.Update(&buffer[0], static_cast<size_t>(file.gcount()));
+	}
+	digest = hash.HexDigest();
+	return true;
+}
+
+// ------------------------------------------------------------------------------------------------
+// Absolute path of an existing file with all links resolved, path itself if it can't be resolved
+std::string CanonicalPath(const std::string& path)
+{
+#ifdef _WIN32
+	char resolved[_MAX_PATH];
+	if (_fullpath(resolved, path.c_str(), _MAX_PATH)) {
+		return resolved;
+	}
+#else
+	if (char* const resolved = realpath(path.c_str(), nullptr)) {
+		const std::string result = resolved;
+		free(resolved);
+		return result;
+	}
+#endif
+	return path;
+}
+
+// ------------------------------------------------------------------------------------------------
+bool FileExists(const std::string& path)
+{
+	return static_cast<bool>(std::ifstream(path.c_str()));
+}
+
+// ------------------------------------------------------------------------------------------------
+bool CopyFile(const std::string& from, const std::string& to)
+{
+	std::ifstream in(from.c_str(), std::ios::binary);
+	std::ofstream out(to.c_str(), std::ios::binary);
+	if (!in || !out) {
+		return false;
+	}
+	out << in.rdbuf();
+	return static_cast<bool>(out);
+}
+
+// ------------------------------------------------------------------------------------------------
+// A name no other process or thread writing to the cache will pick; the server stores
+// conversions from several threads, which may write the same blob or manifest at once
+std::string TemporaryName(const std::string& path)
+{
+	static std::atomic<unsigned long long> counter(0);
+	std::ostringstream s;
+#ifdef _WIN32
+	s << path << ".tmp" << _getpid();
+#else
+	s << path << ".tmp" << getpid();
+#endif
+	s << "." << counter.fetch_add(1);
+	return s.str();
+}
+
+// ------------------------------------------------------------------------------------------------
+// Replaces to with from, atomically where the platform allows it
+bool ReplaceFile(const std::string& from, const std::string& to)
+{
+#ifdef _WIN32
+	std::remove(to.c_str());
+#endif
+	if (std::rename(from.c_str(), to.c_str()) != 0) {
+		std::remove(from.c_str());
+		return false;
+	}
+	return true;
+}
+
+// ------------------------------------------------------------------------------------------------
+// Makes the cached file appear at path, linked if possible
+bool Materialize(const std::string& cached, const std::string& path)
+{
+	// never write through an existing file, it might be linked to another cache entry
+	std::remove(path.c_str());
+#ifndef _WIN32
+	if (link(cached.c_str(), path.c_str()) == 0) {
+		return true;
+	}
+#endif
+	return CopyFile(cached, path);
+}
+
+// ------------------------------------------------------------------------------------------------
+std::string DirectoryOf(const std::string& path)
+{
+	const std::string::size_type sep = path.find_last_of("/\\");
+	return sep == std::string::npos ? std::string() : path.substr(0, sep + 1);
+}
+
+// ------------------------------------------------------------------------------------------------
+void LogInfo(const std::string& message)
+{
+	if (!Assimp::DefaultLogger::isNullLogger()) {
+		Assimp::DefaultLogger::get()->info(message.c_str());
+	}
+}
+
+} // namespace
+
+// ------------------------------------------------------------------------------------------------
+Assimp::IOStream* RecordingIOSystem :: Open(const char* pFile, const char* pMode)
+{
+	Assimp::IOStream* const stream = MappedIOSystem::Open(pFile, pMode);
+	if (stream) {
+		if (pMode[0] == 'r') {
+			readFiles.insert(pFile);
+		}
+		else {
+			writtenFiles.insert(pFile);
+		}
+	}
+	return stream;
+}
+
+// ------------------------------------------------------------------------------------------------
+ConversionCache :: ConversionCache(const std::string& directory, const std::string& signature)
+	: directory(directory), signature(signature)
+{
+	if (!this->directory.empty() && this->directory.find_last_of("/\\") != this->directory.size() - 1) {
+		this->directory += '/';
+	}
+#ifdef _WIN32
+	_mkdir(this->directory.c_str());
+#else
+	mkdir(this->directory.c_str(), 0777);
+#endif
+}
+
+// ------------------------------------------------------------------------------------------------
+bool ConversionCache :: EntryKey(const std::string& input, std::string& key) const
+{
+	std::string inputHash;
+	if (!HashFile(input, inputHash)) {
+		return false;
+	}
+	// the same file in another directory may reference other files next to it, so it's another entry
+	Sha256 hash;
+	hash.Update(ManifestHeader);
+	hash.Update(signature);
+	hash.Update(CanonicalPath(input));
+	hash.Update(inputHash);
+	key = hash.HexDigest();
+	return true;
+}
+
+// ------------------------------------------------------------------------------------------------
+bool ConversionCache :: Fetch(const std::string& input, const std::string& output)
+{
+	std::string key;
+	if (!EntryKey(input, key)) {
+		return false;
+	}
+
+	std::ifstream manifest((directory + key + ".manifest").c_str());
+	std::string line;
+	if (!std::getline(manifest, line) || line != ManifestHeader) {
+		LogInfo("Cache miss: " + input);
+		return false;
+	}
+
+	// all dependencies must be unchanged, and all outputs still be there
+	std::vector<std::pair<std::string, std::string> > outputs;
+	while (std::getline(manifest, line)) {
+		std::istringstream s(line);
+		std::string kind, hash, path;
+		s >> kind >> hash;
+		std::getline(s >> std::ws, path);
+
+		if (kind == "dep") {
+			std::string current;
+			if (!HashFile(path, current) || current != hash) {
+				LogInfo("Cache miss, dependency changed: " + path);
+				return false;
+			}
+		}
+		else if (kind == "out") {
+			if (!FileExists(directory + hash)) {
+				LogInfo("Cache miss, output evicted: " + path);
+				return false;
+			}
+			outputs.push_back(std::make_pair(hash, path));
+		}
+	}
+
+	const std::string outputDirectory = DirectoryOf(output);
+	for (unsigned int i = 0; i < outputs.size(); ++i) {
+		const std::string target = outputs[i].second == MainOutputName ? output : outputDirectory + outputs[i].second;
+		if (!Materialize(directory + outputs[i].first, target)) {
+			LogInfo("Cache miss, failure writing " + target);
+			return false;
+		}
+	}
+	LogInfo("Cache hit: " + input);
+	return true;
+}
+
+// ------------------------------------------------------------------------------------------------
+bool ConversionCache :: Store(const std::string& input, const std::string& output,
+	const std::set<std::string>& dependencies, const std::set<std::string>& outputs)
+{
+	std::string key;
+	if (!EntryKey(input, key)) {
+		return false;
+	}
+
+	std::ostringstream manifest;
+	manifest << ManifestHeader << "\n";
+	for (std::set<std::string>::const_iterator it = dependencies.begin(); it != dependencies.end(); ++it) {
+		std::string hash;
+		if (!HashFile(*it, hash)) {
+			return false;
+		}
+		// canonical, so the check of a later conversion doesn't depend on its working directory
+		manifest << "dep " << hash << " " << CanonicalPath(*it) << "\n";
+	}
+
+	const std::string outputDirectory = DirectoryOf(output);
+	for (std::set<std::string>::const_iterator it = outputs.begin(); it != outputs.end(); ++it) {
+		std::string name;
+		if (*it == output) {
+			name = MainOutputName;
+		}
+		else if (it->compare(0, outputDirectory.size(), outputDirectory) == 0
+			&& it->find_first_of("/\\", outputDirectory.size()) == std::string::npos) {
+			name = it->substr(outputDirectory.size());
+		}
+		else {
+			LogInfo("Not caching, output outside of the output directory: " + *it);
+			return false;
+		}
+
+		std::string hash;
+		if (!HashFile(*it, hash)) {
+			return false;
+		}
+		const std::string blob = directory + hash;
+		if (!FileExists(blob)) {
+			const std::string temporary = TemporaryName(blob);
+			if (!CopyFile(*it, temporary) || !ReplaceFile(temporary, blob)) {
+				std::remove(temporary.c_str());
+				return false;
+			}
+		}
+		manifest << "out " << hash << " " << name << "\n";
+	}
+
+	// the manifest goes last, so it never refers to missing outputs
+	const std::string path = directory + key + ".manifest";
+	const std::string temporary = TemporaryName(path);
+	{
+		std::ofstream file(temporary.c_str());
+		file << manifest.str();
+		if (!file) {
+			std::remove(temporary.c_str());
+			return false;
+		}
+	}
+	return ReplaceFile(temporary, path);
+}
@@ -0,0 +1,101 @@
+/*
+Assimp2Libgdx
+Copyright (c) 2017, Eugene Wang
+
+Licensed under a 3-clause BSD license. See the LICENSE file for more information.
+*/
+
+#ifndef INCLUDED_CONVERSION_CACHE
+#define INCLUDED_CONVERSION_CACHE
+
+#include "mapped_io.h"
+
+#include <string>
+#include <vector>
+#include <set>
+
+// ---------------------------------------------------------------------------
+/** IOSystem that remembers which files were opened, so the conversion cache
+ *  knows what an import depended on and what an export produced.
+ */
+class RecordingIOSystem : public MappedIOSystem
+{
+
+public:
+
+	explicit RecordingIOSystem(bool map = true) : MappedIOSystem(map) {
+	}
+
+public:
+
+	Assimp::IOStream* Open(const char* pFile, const char* pMode = "rb");
+
+	const std::set<std::string>& GetReadFiles() const {
+		return readFiles;
+	}
+
+	const std::set<std::string>& GetWrittenFiles() const {
+		return writtenFiles;
+	}
+
+private:
+
+	std::set<std::string> readFiles;
+	std::set<std::string> writtenFiles;
+};
+
+// ---------------------------------------------------------------------------
+/** On-disk cache of conversion results.
+ *
+ *  Entries are keyed by the canonical path and content of the input file
+ *  and a signature of everything else that affects the output: converter
+ *  version and options. An entry records the content hash and canonical
+ *  path of every file the import read, so changes to referenced files
+ *  (textures, .mtl, external buffers...) invalidate it as well. Outputs
+ *  are stored by their SHA-256, and are materialized as hard links where
+ *  possible, copies otherwise.
+ *
+ *  Writes into the cache go through temporary files and renames, so
+ *  concurrent conversions can share one cache directory.
+ */
+class ConversionCache
+{
+
+public:
+
+	// -------------------------------------------------------------------
+	/** @param directory Cache directory, created if it does not exist
+	 * @param signature Converter version and options, anything that
+	 *   changes the output for the same input
+	 */
+	ConversionCache(const std::string& directory, const std::string& signature);
+
+public:
+
+	// -------------------------------------------------------------------
+	/** Looks up the conversion of input and, on a hit, places the cached
+	 * output at output and any additional files (extracted textures) next
+	 * to it.
+	 * @return true on a hit
+	 */
+	bool Fetch(const std::string& input, const std::string& output);
+
+	// -------------------------------------------------------------------
+	/** Stores a finished conversion.
+	 * @param dependencies All files the import read, input included
+	 * @param outputs All files the export wrote, output included; files
+	 *   outside the directory of output can't be cached
+	 * @return false if the conversion could not be cached
+	 */
+	bool Store(const std::string& input, const std::string& output,
+		const std::set<std::string>& dependencies, const std::set<std::string>& outputs);
+
+private:
+
+	bool EntryKey(const std::string& input, std::string& key) const;
+
+	std::string directory;
+	std::string signature;
+};
+
+#endif // INCLUDED_CONVERSION_CACHE
@@ -0,0 +1,309 @@
+/*
+Assimp2Libgdx
+Copyright (c) 2017, Eugene Wang
+
+Licensed under a 3-clause BSD license. See the LICENSE file for more information.
+*/
+
+#include "conversion_server.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <sstream>
+
+#ifndef _WIN32
+#	include <pthread.h>
+#	include <sys/socket.h>
+#	include <sys/un.h>
+#	include <unistd.h>
+#endif
+
+#ifndef _WIN32
+namespace {
+
+volatile sig_atomic_t stopRequested = 0;
+
+// requests are a command line, anything longer is no request
+const size_t MaxRequestSize = 1 << 20;
+
+// ------------------------------------------------------------------------------------------------
+void OnStopSignal(int)
+{
+	stopRequested = 1;
+}
+
+// ------------------------------------------------------------------------------------------------
+bool SocketAddress(const std::string& path, sockaddr_un& address)
+{
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+		return false;
+	}
+	memcpy(address.sun_path, path.c_str(), path.size());
+	return true;
+}
+
+// ------------------------------------------------------------------------------------------------
+int Connect(const std::string& path)
+{
+	sockaddr_un address;
+	if (!SocketAddress(path, address)) {
+		return -1;
+	}
+	const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0) {
+		return -1;
+	}
+	if (connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+// ------------------------------------------------------------------------------------------------
+bool WriteAll(int fd, const std::string& data)
+{
+	size_t written = 0;
+	while (written < data.size()) {
+		const ssize_t n = write(fd, data.data() + written, data.size() - written);
+		if (n < 0 && errno == EINTR) {
+			continue;
+		}
+		if (n <= 0) {
+			return false;
+		}
+		written += static_cast<size_t>(n);
+	}
+	return true;
+}
+
+// ------------------------------------------------------------------------------------------------
+// Reads until terminator or the end of the stream, the terminator is not stored. Fails once
+// more than limit bytes are read without the terminator, 0 for no limit
+bool ReadUntil(int fd, const char* terminator, std::string& data, size_t limit = 0)
+{
+	char buffer[4096];
+	for (;;) {
+		if (terminator && data.find(terminator) != std::string::npos) {
+			data.erase(data.find(terminator));
+			return true;
+		}
+		if (limit && data.size() > limit) {
+			return false;
+		}
+		const ssize_t n = read(fd, buffer, sizeof(buffer));
+		if (n < 0 && errno == EINTR) {
+			continue;
+		}
+		if (n < 0) {
+			return false;
+		}
+		if (n == 0) {
+			return !terminator;
+		}
+		data.append(buffer, static_cast<size_t>(n));
+	}
+}
+
+} // namespace
+#endif
+
+// ------------------------------------------------------------------------------------------------
+ConversionServer :: ConversionServer(const std::string& socketPath, unsigned int workers, const Handler& handler)
+	: socketPath(socketPath), workerCount(workers), handler(handler), listener(-1), stopping(false)
+{
+	if (!workerCount) {
+		workerCount = std::max(1u, std::thread::hardware_concurrency());
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+ConversionServer :: ~ConversionServer()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	wakeup.notify_all();
+	for (unsigned int i = 0; i < workers.size(); ++i) {
+		workers[i].join();
+	}
+#ifndef _WIN32
+	for (unsigned int i = 0; i < pending.size(); ++i) {
+		close(pending[i]);
+	}
+	if (listener >= 0) {
+		close(listener);
+		unlink(socketPath.c_str());
+	}
+#endif
+}
+
+// ------------------------------------------------------------------------------------------------
+bool ConversionServer :: Run(std::string& error)
+{
+#ifdef _WIN32
+	error = "--serve needs Unix domain sockets, which are not supported on this platform";
+	return false;
+#else
+	sockaddr_un address;
+	if (!SocketAddress(socketPath, address)) {
+		error = "invalid socket path: " + socketPath;
+		return false;
+	}
+
+	// a socket file nobody listens on is left over from a server that died
+	const int existing = Connect(socketPath);
+	if (existing >= 0) {
+		close(existing);
+		error = "a server is already listening on " + socketPath;
+		return false;
+	}
+	unlink(socketPath.c_str());
+
+	listener = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (listener < 0 || bind(listener, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0
+		|| listen(listener, SOMAXCONN) != 0) {
+		error = "failure listening on " + socketPath + ": " + strerror(errno);
+		if (listener >= 0) {
+			close(listener);
+			listener = -1;
+		}
+		return false;
+	}
+
+	// clients going away mid-reply must not take the server down
+	signal(SIGPIPE, SIG_IGN);
+
+	// stop signals interrupt accept(), so they must arrive on this thread rather than a worker
+	struct sigaction action;
+	memset(&action, 0, sizeof(action));
+	action.sa_handler = OnStopSignal;
+	sigaction(SIGINT, &action, nullptr);
+	sigaction(SIGTERM, &action, nullptr);
+
+	sigset_t stopSignals, previous;
+	sigemptyset(&stopSignals);
+	sigaddset(&stopSignals, SIGINT);
+	sigaddset(&stopSignals, SIGTERM);
+	pthread_sigmask(SIG_BLOCK, &stopSignals, &previous);
+	for (unsigned int i = 0; i < workerCount; ++i) {
+		workers.push_back(std::thread(&ConversionServer::Work, this));
+	}
+	pthread_sigmask(SIG_SETMASK, &previous, nullptr);
+
+	while (!stopRequested) {
+		const int connection = accept(listener, nullptr, nullptr);
+		if (connection < 0) {
+			if (errno == EINTR || errno == ECONNABORTED) {
+				continue;
+			}
+			error = std::string("failure accepting connections: ") + strerror(errno);
+			return false;
+		}
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			pending.push_back(connection);
+		}
+		wakeup.notify_one();
+	}
+	return true;
+#endif
+}
+
+// ------------------------------------------------------------------------------------------------
+void ConversionServer :: Work()
+{
+	for (;;) {
+		int connection;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			wakeup.wait(lock, [this] { return stopping || !pending.empty(); });
+			if (stopping) {
+				return;
+			}
+			connection = pending.front();
+			pending.pop_front();
+		}
+		Serve(connection);
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+void ConversionServer :: Serve(int connection)
+{
+#ifndef _WIN32
+	std::string request;
+	if (ReadUntil(connection, "\n\n", request, MaxRequestSize)) {
+		std::vector<std::string> args;
+		std::istringstream lines(request);
+		std::string line;
+		while (std::getline(lines, line)) {
+			args.push_back(line);
+		}
+
+		// a failing request must never take the server and all other requests down with it
+		std::ostringstream messages;
+		int status;
+		try {
+			status = handler(args, messages);
+		}
+		catch (const std::exception& exc) {
+			messages << "conversion failed: " << exc.what() << std::endl;
+			status = -1;
+		}
+		catch (...) {
+			messages << "conversion failed" << std::endl;
+			status = -1;
+		}
+
+		std::ostringstream reply;
+		reply << status << "\n" << messages.str();
+		WriteAll(connection, reply.str());
+	}
+	else if (request.size() > MaxRequestSize) {
+		std::ostringstream reply;
+		reply << -1 << "\n" << "request too large, more than " << MaxRequestSize << " bytes" << std::endl;
+		WriteAll(connection, reply.str());
+	}
+	close(connection);
+#endif
+}
+
+// ------------------------------------------------------------------------------------------------
+bool SendConversionRequest(const std::string& socketPath, const std::vector<std::string>& args,
+	int& status, std::string& messages)
+{
+#ifdef _WIN32
+	return false;
+#else
+	const int fd = Connect(socketPath);
+	if (fd < 0) {
+		return false;
+	}
+
+	std::string request;
+	for (unsigned int i = 0; i < args.size(); ++i) {
+		request += args[i] + "\n";
+	}
+	request += "\n";
+
+	std::string reply;
+	const bool ok = WriteAll(fd, request) && ReadUntil(fd, nullptr, reply);
+	close(fd);
+
+	const std::string::size_type eol = reply.find('\n');
+	if (!ok || eol == std::string::npos) {
+		return false;
+	}
+	status = atoi(reply.substr(0, eol).c_str());
+	messages = reply.substr(eol + 1);
+	return true;
+#endif
+}
@@ -0,0 +1,84 @@
+/*
+Assimp2Libgdx
+Copyright (c) 2017, Eugene Wang
+
+Licensed under a 3-clause BSD license. See the LICENSE file for more information.
+*/
+
+#ifndef INCLUDED_CONVERSION_SERVER
+#define INCLUDED_CONVERSION_SERVER
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+/** Serves conversion requests on a Unix domain socket, so builds converting
+ *  many models pay for process startup and importer setup only once.
+ *
+ *  A request is the command line of a conversion, one argument per line,
+ *  terminated by an empty line. The reply is the exit code of the
+ *  conversion on the first line, followed by its messages. Each connection
+ *  carries one request. Requests of more than a megabyte are refused, and
+ *  exceptions thrown by the handler are replied as failed conversions.
+ *
+ *  Connections are queued and handled by a fixed pool of worker threads;
+ *  the handler is called concurrently and must keep per-thread state
+ *  (importers, exporters) to itself.
+ */
+class ConversionServer
+{
+
+public:
+
+	typedef std::function<int (const std::vector<std::string>& args, std::ostream& messages)> Handler;
+
+	// -------------------------------------------------------------------
+	/** @param socketPath Path of the socket, a stale socket file there is
+	 *   replaced
+	 * @param workers Number of worker threads, 0 for one per core
+	 */
+	ConversionServer(const std::string& socketPath, unsigned int workers, const Handler& handler);
+	~ConversionServer();
+
+public:
+
+	// -------------------------------------------------------------------
+	/** Accepts and handles requests until the process receives SIGINT or
+	 * SIGTERM.
+	 * @return false if the socket could not be set up
+	 */
+	bool Run(std::string& error);
+
+private:
+
+	void Work();
+	void Serve(int connection);
+
+	std::string socketPath;
+	unsigned int workerCount;
+	Handler handler;
+
+	int listener;
+	std::vector<std::thread> workers;
+	std::deque<int> pending;
+	std::mutex mutex;
+	std::condition_variable wakeup;
+	bool stopping;
+};
+
+// ---------------------------------------------------------------------------
+/** Sends a request to a ConversionServer and waits for the reply.
+ * @param status Exit code of the conversion
+ * @param messages Messages of the conversion
+ * @return false if the server could not be reached
+ */
+bool SendConversionRequest(const std::string& socketPath, const std::vector<std::string>& args,
+	int& status, std::string& messages);
+
+#endif // INCLUDED_CONVERSION_SERVER
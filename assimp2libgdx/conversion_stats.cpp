@@ -0,0 +1,180 @@
+/*
+Assimp2Libgdx
+Copyright (c) 2017, Eugene Wang
+
+Licensed under a 3-clause BSD license. See the LICENSE file for more information.
+*/
+
+#include "conversion_stats.h"
+
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <locale>
+
+#ifndef _WIN32
+#	include <sys/resource.h>
+#endif
+
+namespace {
+
+std::atomic<unsigned long long> allocationCount(0);
+thread_local ConversionStats* current = nullptr;
+
+// ------------------------------------------------------------------------------------------------
+double WallSeconds()
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// ------------------------------------------------------------------------------------------------
+// user and system time of the whole process, including worker threads
+double CpuSeconds()
+{
+#ifndef _WIN32
+	rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) == 0) {
+		return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec
+			+ (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) * 1e-6;
+	}
+#endif
+	return static_cast<double>(std::clock()) / CLOCKS_PER_SEC;
+}
+
+// ------------------------------------------------------------------------------------------------
+// peak resident set size in kilobytes, -1 where it is not available
+long PeakRssKb()
+{
+#if defined(__APPLE__)
+	rusage usage;
+	return getrusage(RUSAGE_SELF, &usage) == 0 ? static_cast<long>(usage.ru_maxrss / 1024) : -1;
+#elif !defined(_WIN32)
+	rusage usage;
+	return getrusage(RUSAGE_SELF, &usage) == 0 ? static_cast<long>(usage.ru_maxrss) : -1;
+#else
+	return -1;
+#endif
+}
+
+// ------------------------------------------------------------------------------------------------
+void WriteString(std::ostream& out, const std::string& s)
+{
+	out << '\"';
+	for (unsigned int i = 0; i < s.size(); ++i) {
+		if (s[i] == '\\' || s[i] == '\"') {
+			out << '\\';
+		}
+		out << s[i];
+	}
+	out << '\"';
+}
+
+} // namespace
+
+// ------------------------------------------------------------------------------------------------
+void CountAllocation()
+{
+	allocationCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+// ------------------------------------------------------------------------------------------------
+unsigned long long GetAllocationCount()
+{
+	return allocationCount.load(std::memory_order_relaxed);
+}
+
+// ------------------------------------------------------------------------------------------------
+ConversionStats :: Scope :: Scope(const char* name)
+	: stats(current), index(0), wallStart(0), cpuStart(0), allocationsStart(0)
+{
+	if (!stats) {
+		return;
+	}
+
+	Stage stage;
+	stage.name = name;
+	stage.depth = stats->depth++;
+	stage.wallSeconds = stage.cpuSeconds = 0;
+	stage.peakRssKb = -1;
+	stage.allocations = stage.bytes = 0;
+	index = stats->stages.size();
+	stats->stages.push_back(stage);
+
+	// sample last, so the bookkeeping above is not part of the stage
+	allocationsStart = GetAllocationCount();
+	cpuStart = CpuSeconds();
+	wallStart = WallSeconds();
+}
+
+// ------------------------------------------------------------------------------------------------
+ConversionStats :: Scope :: ~Scope()
+{
+	if (!stats) {
+		return;
+	}
+
+	Stage& stage = stats->stages[index];
+	stage.wallSeconds = WallSeconds() - wallStart;
+	stage.cpuSeconds = CpuSeconds() - cpuStart;
+	stage.allocations = GetAllocationCount() - allocationsStart;
+	stage.peakRssKb = PeakRssKb();
+	--stats->depth;
+}
+
+// ------------------------------------------------------------------------------------------------
+void ConversionStats :: Scope :: SetBytes(unsigned long long bytes)
+{
+	if (stats) {
+		stats->stages[index].bytes = bytes;
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+ConversionStats :: ConversionStats() : depth(0)
+{
+}
+
+// ------------------------------------------------------------------------------------------------
+ConversionStats :: ~ConversionStats()
+{
+	if (current == this) {
+		current = nullptr;
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+void ConversionStats :: SetCurrent(ConversionStats* stats)
+{
+	current = stats;
+}
+
+// ------------------------------------------------------------------------------------------------
+ConversionStats* ConversionStats :: GetCurrent()
+{
+	return current;
+}
+
+// ------------------------------------------------------------------------------------------------
+void ConversionStats :: WriteJson(std::ostream& out, const std::string& input) const
+{
+	const std::locale previous = out.imbue(std::locale("C"));
+
+	out << "{\n\t\"input\": ";
+	WriteString(out, input);
+	out << ",\n\t\"stages\": [";
+	for (unsigned int i = 0; i < stages.size(); ++i) {
+		const Stage& stage = stages[i];
+		out << (i ? ",\n\t\t{" : "\n\t\t{");
+		out << "\"name\": ";
+		WriteString(out, stage.name);
+		out << ", \"depth\": " << stage.depth;
+		out << ", \"wall\": " << stage.wallSeconds;
+		out << ", \"cpu\": " << stage.cpuSeconds;
+		out << ", \"peakRssKb\": " << stage.peakRssKb;
+		out << ", \"allocations\": " << stage.allocations;
+		out << ", \"bytes\": " << stage.bytes << "}";
+	}
+	out << "\n\t]\n}\n";
+
+	out.imbue(previous);
+}
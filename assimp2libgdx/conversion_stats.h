@@ -0,0 +1,102 @@
+/*
+Assimp2Libgdx
+Copyright (c) 2017, Eugene Wang
+
+Licensed under a 3-clause BSD license. See the LICENSE file for more information.
+*/
+
+#ifndef INCLUDED_CONVERSION_STATS
+#define INCLUDED_CONVERSION_STATS
+
+#include <string>
+#include <vector>
+#include <ostream>
+
+// ---------------------------------------------------------------------------
+/** Records wall time, cpu time, peak memory, allocations and output bytes of
+ *  the stages of a conversion.
+ *
+ *  Stages are measured with ConversionStats::Scope, which reports to the
+ *  ConversionStats installed for the current thread with SetCurrent(). If
+ *  none is installed, scopes cost next to nothing, so they can stay in the
+ *  code unconditionally.
+ *
+ *  CPU time, peak RSS and allocations are process wide, worker threads of
+ *  the exporter included, so the numbers only hold while a single conversion
+ *  runs in the process: conversions running concurrently, as in a server,
+ *  would be charged for each other's work. Allocations are only counted if
+ *  the program routes operator new through CountAllocation().
+ */
+class ConversionStats
+{
+
+public:
+
+	struct Stage
+	{
+		std::string name;
+		unsigned int depth; // nesting level, stage 0 contains the deeper ones following it
+		double wallSeconds;
+		double cpuSeconds;
+		long peakRssKb;
+		unsigned long long allocations;
+		unsigned long long bytes; // output bytes produced by the stage
+	};
+
+	// -------------------------------------------------------------------
+	/** Measures a stage from construction to destruction. Stages are
+	 * recorded in the order they begin.
+	 */
+	class Scope
+	{
+	public:
+		explicit Scope(const char* name);
+		~Scope();
+
+		void SetBytes(unsigned long long bytes);
+
+	private:
+		Scope(const Scope&);
+		Scope& operator=(const Scope&);
+
+		ConversionStats* stats;
+		size_t index;
+		double wallStart;
+		double cpuStart;
+		unsigned long long allocationsStart;
+	};
+
+public:
+
+	ConversionStats();
+	~ConversionStats();
+
+public:
+
+	// -------------------------------------------------------------------
+	/** Installs the stats that scopes on the calling thread report to,
+	 * nullptr to stop recording.
+	 */
+	static void SetCurrent(ConversionStats* stats);
+	static ConversionStats* GetCurrent();
+
+	const std::vector<Stage>& GetStages() const {
+		return stages;
+	}
+
+	// -------------------------------------------------------------------
+	/** Writes the report as a json object, input names the converted file. */
+	void WriteJson(std::ostream& out, const std::string& input) const;
+
+private:
+
+	std::vector<Stage> stages;
+	unsigned int depth;
+};
+
+// ---------------------------------------------------------------------------
+/** Allocation counter, to be called from a replacement operator new. */
+void CountAllocation();
+unsigned long long GetAllocationCount();
+
+#endif // INCLUDED_CONVERSION_STATS
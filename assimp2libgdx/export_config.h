@@ -0,0 +1,191 @@
+/*
+Assimp2Libgdx
+Copyright (c) 2017, Eugene Wang
+
+Licensed under a 3-clause BSD license. See the LICENSE file for more information.
+*/
+
+#ifndef INCLUDED_EXPORT_CONFIG
+#define INCLUDED_EXPORT_CONFIG
+
+// ----------------------------------------------------------------------------
+// Keys for the Assimp::ExportProperties understood by the g3dj exporter.
+// These follow the naming of assimp's own AI_CONFIG_XXX keys, along with
+// the defaults that are used if a property isn't set.
+// ----------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------
+/** @brief Maximum number of bones a single mesh part may reference.
+ *
+ * Skinned meshes referencing more bones are split, so that each part fits
+ * into the bone palette of a single draw call. 0 disables the bone limit.
+ * Property type: integer.
+ */
+#define A2L_CONFIG_MAX_BONES_PER_PART "A2L_MAX_BONES_PER_PART"
+
+#if (!defined A2L_DEFAULT_MAX_BONES_PER_PART)
+#	define A2L_DEFAULT_MAX_BONES_PER_PART 0
+#endif
+
+// ---------------------------------------------------------------------------
+/** @brief Width of the index buffers the runtime uses, in bits.
+ *
+ * 15 is a 16 bit buffer of signed indices, 16 one of unsigned indices.
+ * Meshes with more vertices than the indices can address are split. With
+ * 32 meshes are never split by vertex count, only meshes which need it
+ * get 32 bit indices. Every mesh is written with its "indexType".
+ * Property type: integer (15, 16 or 32).
+ */
+#define A2L_CONFIG_INDEX_BITS "A2L_INDEX_BITS"
+
+#if (!defined A2L_DEFAULT_INDEX_BITS)
+#	define A2L_DEFAULT_INDEX_BITS 15
+#endif
+
+// ---------------------------------------------------------------------------
+/** @brief Whether triangles are written as triangle strips.
+ *
+ * The triangles of every part are joined into one strip, with degenerate
+ * triangles between strips, and the part becomes a TRIANGLE_STRIP if that
+ * takes fewer indices than the triangle list.
+ * Property type: bool (integer).
+ */
+#define A2L_CONFIG_TRIANGLE_STRIPS "A2L_TRIANGLE_STRIPS"
+
+#if (!defined A2L_DEFAULT_TRIANGLE_STRIPS)
+#	define A2L_DEFAULT_TRIANGLE_STRIPS 0
+#endif
+
+// ---------------------------------------------------------------------------
+/** @brief How far apart the positions of vertices may be to be joined,
+ * relative to the diagonal of the mesh's bounding box.
+ *
+ * Joins the near duplicates left by float noise, which
+ * JoinIdenticalVertices misses, before meshes are split. 0 disables
+ * welding.
+ * Property type: float.
+ */
+#define A2L_CONFIG_WELD_EPSILON "A2L_WELD_EPSILON"
+
+#if (!defined A2L_DEFAULT_WELD_EPSILON)
+#	define A2L_DEFAULT_WELD_EPSILON 0.0f
+#endif
+
+// ---------------------------------------------------------------------------
+/** @brief Largest angle between the normals, tangents and bitangents of
+ * vertices that are welded, in degrees.
+ * Property type: float.
+ */
+#define A2L_CONFIG_WELD_NORMAL_ANGLE "A2L_WELD_NORMAL_ANGLE"
+
+#if (!defined A2L_DEFAULT_WELD_NORMAL_ANGLE)
+#	define A2L_DEFAULT_WELD_NORMAL_ANGLE 1.0f
+#endif
+
+// ---------------------------------------------------------------------------
+/** @brief How far apart the texture coordinates of vertices that are
+ * welded may be, in each component.
+ * Property type: float.
+ */
+#define A2L_CONFIG_WELD_UV_EPSILON "A2L_WELD_UV_EPSILON"
+
+#if (!defined A2L_DEFAULT_WELD_UV_EPSILON)
+#	define A2L_DEFAULT_WELD_UV_EPSILON 1e-5f
+#endif
+
+// ---------------------------------------------------------------------------
+/** @brief Maximum size of the texture atlases built for materials which only
+ * differ in their diffuse texture.
+ *
+ * Meshes using such materials are moved onto a shared atlas material and 
+ * merged, which saves draw calls. 0 disables atlas generation.
+ * Property type: integer.
+ */
+#define A2L_CONFIG_TEXTURE_ATLAS_SIZE "A2L_TEXTURE_ATLAS_SIZE"
+
+#if (!defined A2L_DEFAULT_TEXTURE_ATLAS_SIZE)
+#	define A2L_DEFAULT_TEXTURE_ATLAS_SIZE 0
+#endif
+
+// ---------------------------------------------------------------------------
+/** @brief Number of reduced levels of detail generated for every triangle
+ * mesh.
+ *
+ * Levels are written as additional meshes, and listed under "lods" by the
+ * nodes using the original mesh. 0 disables level of detail generation.
+ * Property type: integer.
+ */
+#define A2L_CONFIG_LOD_LEVELS "A2L_LOD_LEVELS"
+
+#if (!defined A2L_DEFAULT_LOD_LEVELS)
+#	define A2L_DEFAULT_LOD_LEVELS 0
+#endif
+
+// ---------------------------------------------------------------------------
+/** @brief Fraction of the triangles of the previous level each level of
+ * detail keeps.
+ * Property type: float (0 or more, below 1).
+ */
+#define A2L_CONFIG_LOD_RATIO "A2L_LOD_RATIO"
+
+#if (!defined A2L_DEFAULT_LOD_RATIO)
+#	define A2L_DEFAULT_LOD_RATIO 0.5f
+#endif
+
+// ---------------------------------------------------------------------------
+/** @brief How far simplification may move the surface of a mesh, relative
+ * to the diagonal of its bounding box.
+ *
+ * Levels which can't reach their triangle budget within this error end up
+ * with more triangles, or aren't generated at all. 0 means no limit.
+ * Property type: float.
+ */
+#define A2L_CONFIG_LOD_MAX_ERROR "A2L_LOD_MAX_ERROR"
+
+#if (!defined A2L_DEFAULT_LOD_MAX_ERROR)
+#	define A2L_DEFAULT_LOD_MAX_ERROR 0.0f
+#endif
+
+// ---------------------------------------------------------------------------
+/** @brief Whether static nodes are collapsed before export.
+ *
+ * Nodes which aren't animated, bones, cameras or lights, and have no
+ * skinned meshes, are removed along with their transforms, which are baked
+ * into the vertices of their meshes. Meshes which end up on the same node
+ * with the same material are merged.
+ * Property type: bool (integer).
+ */
+#define A2L_CONFIG_FLATTEN_STATIC "A2L_FLATTEN_STATIC"
+
+#if (!defined A2L_DEFAULT_FLATTEN_STATIC)
+#	define A2L_DEFAULT_FLATTEN_STATIC 0
+#endif
+
+// ---------------------------------------------------------------------------
+/** @brief Whether the json is indented with tabs.
+ *
+ * Without indentation, every value still starts on a line of its own, but
+ * the output is considerably smaller for large meshes.
+ * Property type: bool (integer).
+ */
+#define A2L_CONFIG_INDENT "A2L_INDENT"
+
+#if (!defined A2L_DEFAULT_INDENT)
+#	define A2L_DEFAULT_INDENT 1
+#endif
+
+// ---------------------------------------------------------------------------
+/** @brief Whether infinite and NaN floats are written as the strings
+ * "Infinity", "-Infinity" and "NaN".
+ *
+ * JSON has no literals for them, most parsers accept these strings though.
+ * Otherwise they are written as 0.0.
+ * Property type: bool (integer).
+ */
+#define A2L_CONFIG_WRITE_SPECIAL_FLOATS "A2L_WRITE_SPECIAL_FLOATS"
+
+#if (!defined A2L_DEFAULT_WRITE_SPECIAL_FLOATS)
+#	define A2L_DEFAULT_WRITE_SPECIAL_FLOATS 1
+#endif
+
+#endif // INCLUDED_EXPORT_CONFIG
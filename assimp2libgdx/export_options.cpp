@@ -0,0 +1,228 @@
+/*
+Assimp2Libgdx
+Copyright (c) 2017, Eugene Wang
+
+Licensed under a 3-clause BSD license. See the LICENSE file for more information.
+*/
+
+#include "export_options.h"
+
+#include <assimp/Exporter.hpp>
+
+#include <cerrno>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <sstream>
+
+namespace {
+
+typedef Assimp2LibgdxOptions Options;
+
+const double Unbounded = std::numeric_limits<float>::max();
+
+// ------------------------------------------------------------------------------------------------
+// An option, which is stored in exactly one of integer, boolean and real
+struct OptionEntry
+{
+	const char* flag; // without the leading --
+	const char* key; // nullptr for options of the command line tool only
+	int Options::* integer;
+	bool Options::* boolean;
+	float Options::* real;
+	double defaultValue;
+	double min, max;
+};
+
+// every option, in the order of the help text
+const OptionEntry Entries[] = {
+	{ "maxbones", A2L_CONFIG_MAX_BONES_PER_PART, &Options::maxBonesPerPart, nullptr, nullptr, A2L_DEFAULT_MAX_BONES_PER_PART, 0, INT_MAX },
+	{ "index-bits", A2L_CONFIG_INDEX_BITS, &Options::indexBits, nullptr, nullptr, A2L_DEFAULT_INDEX_BITS, 15, 32 },
+	{ "weld", A2L_CONFIG_WELD_EPSILON, nullptr, nullptr, &Options::weldEpsilon, A2L_DEFAULT_WELD_EPSILON, 0, 1 },
+	{ "weld-angle", A2L_CONFIG_WELD_NORMAL_ANGLE, nullptr, nullptr, &Options::weldNormalAngle, A2L_DEFAULT_WELD_NORMAL_ANGLE, 0, 180 },
+	{ "weld-uv", A2L_CONFIG_WELD_UV_EPSILON, nullptr, nullptr, &Options::weldUVEpsilon, A2L_DEFAULT_WELD_UV_EPSILON, 0, Unbounded },
+	{ "strips", A2L_CONFIG_TRIANGLE_STRIPS, nullptr, &Options::triangleStrips, nullptr, A2L_DEFAULT_TRIANGLE_STRIPS, 0, 1 },
+	{ "flatten", A2L_CONFIG_FLATTEN_STATIC, nullptr, &Options::flattenStatic, nullptr, A2L_DEFAULT_FLATTEN_STATIC, 0, 1 },
+	{ "atlas", A2L_CONFIG_TEXTURE_ATLAS_SIZE, &Options::textureAtlasSize, nullptr, nullptr, A2L_DEFAULT_TEXTURE_ATLAS_SIZE, 0, INT_MAX },
+	{ "lod", A2L_CONFIG_LOD_LEVELS, &Options::lodLevels, nullptr, nullptr, A2L_DEFAULT_LOD_LEVELS, 0, INT_MAX },
+	{ "lod-ratio", A2L_CONFIG_LOD_RATIO, nullptr, nullptr, &Options::lodRatio, A2L_DEFAULT_LOD_RATIO, 0, 1 },
+	{ "lod-error", A2L_CONFIG_LOD_MAX_ERROR, nullptr, nullptr, &Options::lodMaxError, A2L_DEFAULT_LOD_MAX_ERROR, 0, Unbounded },
+	{ "indent", A2L_CONFIG_INDENT, nullptr, &Options::indent, nullptr, A2L_DEFAULT_INDENT, 0, 1 },
+	{ "special-floats", A2L_CONFIG_WRITE_SPECIAL_FLOATS, nullptr, &Options::specialFloats, nullptr, A2L_DEFAULT_WRITE_SPECIAL_FLOATS, 0, 1 },
+	// 175 degrees is the most assimp's normal and tangent smoothing accepts
+	{ "smoothing", nullptr, nullptr, nullptr, &Options::smoothingAngle, 70, 0, 175 },
+	{ "workers", nullptr, &Options::workers, nullptr, nullptr, 0, 0, INT_MAX },
+};
+
+const unsigned int NumEntries = sizeof(Entries) / sizeof(Entries[0]);
+
+// ------------------------------------------------------------------------------------------------
+const OptionEntry* FindEntry(const std::string& flag)
+{
+	for (unsigned int i = 0; i < NumEntries; ++i) {
+		if (flag == Entries[i].flag) {
+			return &Entries[i];
+		}
+	}
+	return nullptr;
+}
+
+// ------------------------------------------------------------------------------------------------
+double GetValue(const Options& options, const OptionEntry& entry)
+{
+	return entry.integer ? options.*entry.integer : entry.boolean ? options.*entry.boolean : options.*entry.real;
+}
+
+void SetValue(Options& options, const OptionEntry& entry, double value)
+{
+	if (entry.integer) {
+		options.*entry.integer = static_cast<int>(value);
+	}
+	else if (entry.boolean) {
+		options.*entry.boolean = value != 0;
+	}
+	else {
+		options.*entry.real = static_cast<float>(value);
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+bool CheckValue(const OptionEntry& entry, double value, std::string& error)
+{
+	std::ostringstream s;
+	if (!(value >= entry.min && value <= entry.max)) {
+		s << "--" << entry.flag << " must be ";
+		if (entry.max >= Unbounded || entry.max == INT_MAX) {
+			s << "at least " << entry.min;
+		}
+		else {
+			s << "between " << entry.min << " and " << entry.max;
+		}
+		s << ", not " << value;
+	}
+	else if (entry.integer == &Options::indexBits && value != 15 && value != 16 && value != 32) {
+		s << "unsupported index width " << value << ", must be 15, 16 or 32";
+	}
+	else if (entry.real == &Options::lodRatio && value >= 1) {
+		// levels keeping all triangles of the last one are never coarser
+		s << "--" << entry.flag << " must be below 1, not " << value;
+	}
+	else {
+		return true;
+	}
+	error = s.str();
+	return false;
+}
+
+// ------------------------------------------------------------------------------------------------
+// Parses the text of a flag, strictly, so typos aren't taken for 0
+bool ParseValue(const OptionEntry& entry, const std::string& text, double& value)
+{
+	if (entry.boolean) {
+		if (text.empty() || text == "1" || text == "true") {
+			value = 1;
+			return true;
+		}
+		if (text == "0" || text == "false") {
+			value = 0;
+			return true;
+		}
+		return false;
+	}
+	if (text.empty()) {
+		return false;
+	}
+
+	char* end;
+	errno = 0;
+	if (entry.integer) {
+		const long l = std::strtol(text.c_str(), &end, 10);
+		value = static_cast<double>(l);
+	}
+	else {
+		value = std::strtod(text.c_str(), &end);
+	}
+	return *end == '\0' && errno == 0 && std::isfinite(value);
+}
+
+} //
+
+// ------------------------------------------------------------------------------------------------
+Assimp2LibgdxOptions :: Assimp2LibgdxOptions()
+{
+	for (unsigned int i = 0; i < NumEntries; ++i) {
+		SetValue(*this, Entries[i], Entries[i].defaultValue);
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+Assimp2LibgdxOptions :: Assimp2LibgdxOptions(const Assimp::ExportProperties& props)
+{
+	for (unsigned int i = 0; i < NumEntries; ++i) {
+		const OptionEntry& entry = Entries[i];
+		if (!entry.key) {
+			SetValue(*this, entry, entry.defaultValue);
+		}
+		else if (entry.real) {
+			SetValue(*this, entry, props.GetPropertyFloat(entry.key, static_cast<ai_real>(entry.defaultValue)));
+		}
+		else {
+			SetValue(*this, entry, props.GetPropertyInteger(entry.key, static_cast<int>(entry.defaultValue)));
+		}
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+void Assimp2LibgdxOptions :: Store(Assimp::ExportProperties& props) const
+{
+	for (unsigned int i = 0; i < NumEntries; ++i) {
+		const OptionEntry& entry = Entries[i];
+		if (!entry.key) {
+			continue;
+		}
+		if (entry.real) {
+			props.SetPropertyFloat(entry.key, static_cast<ai_real>(this->*entry.real));
+		}
+		else {
+			props.SetPropertyInteger(entry.key, static_cast<int>(GetValue(*this, entry)));
+		}
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+bool Assimp2LibgdxOptions :: Validate(std::string& error) const
+{
+	for (unsigned int i = 0; i < NumEntries; ++i) {
+		if (!CheckValue(Entries[i], GetValue(*this, Entries[i]), error)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// ------------------------------------------------------------------------------------------------
+bool Assimp2LibgdxOptions :: IsFlag(const std::string& name)
+{
+	return FindEntry(name) != nullptr;
+}
+
+// ------------------------------------------------------------------------------------------------
+bool Assimp2LibgdxOptions :: SetFlag(const std::string& name, const std::string& value, std::string& error)
+{
+	const OptionEntry* const entry = FindEntry(name);
+	if (!entry) {
+		error = "unrecognized flag: --" + name;
+		return false;
+	}
+	double parsed;
+	if (!ParseValue(*entry, value, parsed)) {
+		error = "invalid value for --" + name + ": " + value;
+		return false;
+	}
+	if (!CheckValue(*entry, parsed, error)) {
+		return false;
+	}
+	SetValue(*this, *entry, parsed);
+	return true;
+}
@@ -0,0 +1,85 @@
+/*
+Assimp2Libgdx
+Copyright (c) 2017, Eugene Wang
+
+Licensed under a 3-clause BSD license. See the LICENSE file for more information.
+*/
+
+#ifndef INCLUDED_EXPORT_OPTIONS
+#define INCLUDED_EXPORT_OPTIONS
+
+#include <string>
+
+#include "export_config.h"
+
+namespace Assimp {
+	class ExportProperties;
+}
+
+// ---------------------------------------------------------------------------
+/** Options of an export, see export_config.h for what each of them does.
+ *
+ *  Every option has a command line flag, a A2L_CONFIG_XXX property, a
+ *  default and a range of valid values, all kept in a single table, so the
+ *  command line, the properties passed to Assimp::Exporter and library
+ *  callers all go through the same parsing and validation. Default
+ *  constructed options hold the defaults. The few options of the command
+ *  line tool which the exporter doesn't use share the table, without a
+ *  property.
+ */
+struct Assimp2LibgdxOptions
+{
+	Assimp2LibgdxOptions();
+
+	// -------------------------------------------------------------------
+	/** Reads the options from the A2L_CONFIG_XXX properties, using the
+	 * defaults for those which aren't set. */
+	explicit Assimp2LibgdxOptions(const Assimp::ExportProperties& props);
+
+	// -------------------------------------------------------------------
+	/** Writes all options to their A2L_CONFIG_XXX properties. */
+	void Store(Assimp::ExportProperties& props) const;
+
+	// -------------------------------------------------------------------
+	/** Checks that every option is within its range.
+	 * @param error Receives the problem with the first invalid option
+	 * @return false if an option is invalid
+	 */
+	bool Validate(std::string& error) const;
+
+	// -------------------------------------------------------------------
+	/** Whether name, without the leading --, is the flag of an option. */
+	static bool IsFlag(const std::string& name);
+
+	// -------------------------------------------------------------------
+	/** Sets the option of a flag from its value. Boolean options take an
+	 * empty value, 1 or true to turn them on, and 0 or false to turn them
+	 * off.
+	 * @param name The flag, without the leading --
+	 * @param value The text after the =, empty if there is none
+	 * @param error Receives why the value was rejected
+	 * @return false, leaving the option unchanged, if the value doesn't
+	 *   parse or is out of range
+	 */
+	bool SetFlag(const std::string& name, const std::string& value, std::string& error);
+
+	int indexBits; // 15, 16 or 32
+	int maxBonesPerPart;
+	bool triangleStrips;
+	float weldEpsilon;
+	float weldNormalAngle;
+	float weldUVEpsilon;
+	int textureAtlasSize;
+	int lodLevels;
+	float lodRatio;
+	float lodMaxError;
+	bool flattenStatic;
+	bool indent;
+	bool specialFloats;
+
+	// command line tool only
+	float smoothingAngle; // of normals and tangents, in degrees
+	int workers; // of the conversion server, 0 for one per core
+};
+
+#endif // INCLUDED_EXPORT_OPTIONS
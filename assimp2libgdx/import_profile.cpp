@@ -0,0 +1,162 @@
+/*
+Assimp2Libgdx
+Copyright (c) 2017, Eugene Wang
+
+Licensed under a 3-clause BSD license. See the LICENSE file for more information.
+*/
+
+#include "import_profile.h"
+
+#include <assimp/Importer.hpp>
+#include <assimp/postprocess.h>
+#include <assimp/config.h>
+
+#include <chrono>
+#include <climits>
+#include <sstream>
+
+// ------------------------------------------------------------------------------------------------
+const std::vector<PostProcessStep>& GetPostProcessSteps()
+{
+	// in the order of assimp's PostStepRegistry.cpp. ValidateDataStructure isn't part of
+	// it, the importer runs it ahead of all other steps. SplitLargeMeshes is made of two
+	// registry steps, which split by triangles and by vertices, listed where they run
+	static const std::vector<PostProcessStep> steps = {
+		{ "ValidateDataStructure", aiProcess_ValidateDataStructure, nullptr, 0 },
+		{ "MakeLeftHanded", aiProcess_MakeLeftHanded, nullptr, 0 },
+		{ "FlipUVs", aiProcess_FlipUVs, nullptr, 0 },
+		{ "FlipWindingOrder", aiProcess_FlipWindingOrder, nullptr, 0 },
+		{ "RemoveComponent", aiProcess_RemoveComponent, nullptr, 0 },
+		{ "RemoveRedundantMaterials", aiProcess_RemoveRedundantMaterials, nullptr, 0 },
+		{ "FindInstances", aiProcess_FindInstances, nullptr, 0 },
+		{ "OptimizeGraph", aiProcess_OptimizeGraph, nullptr, 0 },
+		{ "OptimizeMeshes", aiProcess_OptimizeMeshes, nullptr, 0 },
+		{ "FindDegenerates", aiProcess_FindDegenerates, nullptr, 0 },
+		{ "GenUVCoords", aiProcess_GenUVCoords, nullptr, 0 },
+		{ "TransformUVCoords", aiProcess_TransformUVCoords, nullptr, 0 },
+		{ "PreTransformVertices", aiProcess_PreTransformVertices, nullptr, 0 },
+		{ "Triangulate", aiProcess_Triangulate, nullptr, 0 },
+		{ "SortByPType", aiProcess_SortByPType, nullptr, 0 },
+		{ "FindInvalidData", aiProcess_FindInvalidData, nullptr, 0 },
+		{ "FixInfacingNormals", aiProcess_FixInfacingNormals, nullptr, 0 },
+		{ "SplitByBoneCount", aiProcess_SplitByBoneCount, nullptr, 0 },
+		{ "SplitLargeMeshes", aiProcess_SplitLargeMeshes, AI_CONFIG_PP_SLM_VERTEX_LIMIT, AI_SLM_DEFAULT_MAX_VERTICES },
+		{ "GenNormals", aiProcess_GenNormals, nullptr, 0 },
+		{ "GenSmoothNormals", aiProcess_GenSmoothNormals, nullptr, 0 },
+		{ "CalcTangentSpace", aiProcess_CalcTangentSpace, nullptr, 0 },
+		{ "JoinIdenticalVertices", aiProcess_JoinIdenticalVertices, nullptr, 0 },
+		{ "SplitLargeMeshes", aiProcess_SplitLargeMeshes, AI_CONFIG_PP_SLM_TRIANGLE_LIMIT, AI_SLM_DEFAULT_MAX_TRIANGLES },
+		{ "Debone", aiProcess_Debone, nullptr, 0 },
+		{ "LimitBoneWeights", aiProcess_LimitBoneWeights, nullptr, 0 },
+		{ "ImproveCacheLocality", aiProcess_ImproveCacheLocality, nullptr, 0 },
+	};
+	return steps;
+}
+
+// ------------------------------------------------------------------------------------------------
+bool GetProfileFlags(const std::string& profile, unsigned int& flags)
+{
+	if (profile == "fast") {
+		flags = aiProcessPreset_TargetRealtime_Fast;
+	}
+	else if (profile == "balanced") {
+		flags = aiProcessPreset_TargetRealtime_Quality;
+	}
+	else if (profile == "max") {
+		flags = aiProcessPreset_TargetRealtime_MaxQuality;
+	}
+	else {
+		return false;
+	}
+	return true;
+}
+
+// ------------------------------------------------------------------------------------------------
+bool ApplyStepOverrides(const std::string& overrides, unsigned int& flags, std::string& error)
+{
+	const std::vector<PostProcessStep>& steps = GetPostProcessSteps();
+
+	std::stringstream list(overrides);
+	std::string item;
+	while (std::getline(list, item, ',')) {
+		if (item.empty()) {
+			continue;
+		}
+		const bool add = item[0] != '-';
+		const std::string name = (item[0] == '+' || item[0] == '-') ? item.substr(1) : item;
+
+		unsigned int flag = 0;
+		for (unsigned int i = 0; i < steps.size(); ++i) {
+			if (name == steps[i].name) {
+				flag = steps[i].flag;
+				break;
+			}
+		}
+		if (!flag) {
+			error = "unknown post processing step: " + name;
+			return false;
+		}
+		if (add) {
+			flags |= flag;
+		}
+		else {
+			flags &= ~flag;
+		}
+	}
+	return true;
+}
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+// ------------------------------------------------------------------------------------------------
+const aiScene* ApplyPostProcessingTimed(Assimp::Importer& imp, const aiScene* scene, unsigned int flags,
+	std::vector<std::pair<std::string, double> >& timings)
+{
+	// running the steps in registry order, one at a time, gives the same result as
+	// running them all at once
+	const std::vector<PostProcessStep>& steps = GetPostProcessSteps();
+	for (unsigned int i = 0; scene && i < steps.size(); ++i) {
+		if (!(flags & steps[i].flag)) {
+			continue;
+		}
+		std::string name = steps[i].name;
+		int limit = 0;
+		if (steps[i].liftedLimit) {
+			// only one half of SplitLargeMeshes runs here, the other one never splits
+			limit = imp.GetPropertyInteger(steps[i].liftedLimit, steps[i].defaultLimit);
+			imp.SetPropertyInteger(steps[i].liftedLimit, INT_MAX);
+			name += steps[i].liftedLimit == std::string(AI_CONFIG_PP_SLM_VERTEX_LIMIT) ? " (triangles)" : " (vertices)";
+		}
+		const Clock::time_point start = Clock::now();
+		scene = imp.ApplyPostProcessing(steps[i].flag);
+		timings.push_back(std::make_pair(name, std::chrono::duration<double>(Clock::now() - start).count()));
+		if (steps[i].liftedLimit) {
+			imp.SetPropertyInteger(steps[i].liftedLimit, limit);
+		}
+	}
+	return scene;
+}
+
+} // namespace
+
+// ------------------------------------------------------------------------------------------------
+const aiScene* ReadFileTimed(Assimp::Importer& imp, const char* file, unsigned int flags,
+	std::vector<std::pair<std::string, double> >& timings)
+{
+	const Clock::time_point start = Clock::now();
+	const aiScene* const scene = imp.ReadFile(file, 0);
+	timings.push_back(std::make_pair(std::string("import"), std::chrono::duration<double>(Clock::now() - start).count()));
+	return ApplyPostProcessingTimed(imp, scene, flags, timings);
+}
+
+// ------------------------------------------------------------------------------------------------
+const aiScene* ReadFileFromMemoryTimed(Assimp::Importer& imp, const void* buffer, size_t length, const char* hint,
+	unsigned int flags, std::vector<std::pair<std::string, double> >& timings)
+{
+	const Clock::time_point start = Clock::now();
+	const aiScene* const scene = imp.ReadFileFromMemory(buffer, length, 0, hint);
+	timings.push_back(std::make_pair(std::string("import"), std::chrono::duration<double>(Clock::now() - start).count()));
+	return ApplyPostProcessingTimed(imp, scene, flags, timings);
+}
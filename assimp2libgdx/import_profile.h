@@ -0,0 +1,73 @@
+/*
+Assimp2Libgdx
+Copyright (c) 2017, Eugene Wang
+
+Licensed under a 3-clause BSD license. See the LICENSE file for more information.
+*/
+
+#ifndef INCLUDED_IMPORT_PROFILE
+#define INCLUDED_IMPORT_PROFILE
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace Assimp {
+	class Importer;
+}
+struct aiScene;
+
+// ----------------------------------------------------------------------------
+// Named sets of assimp post processing steps, so not every asset has to pay
+// for aiProcessPreset_TargetRealtime_MaxQuality.
+// ----------------------------------------------------------------------------
+
+struct PostProcessStep
+{
+	const char* name; // aiProcess_<name>
+	unsigned int flag;
+
+	// for steps which are only a part of flag: the AI_CONFIG_XXX limit to lift
+	// so the other parts don't do anything, and its default. NULL otherwise
+	const char* liftedLimit;
+	int defaultLimit;
+};
+
+// ---------------------------------------------------------------------------
+/** Returns all post processing steps, in the order assimp executes them.
+ *  SplitLargeMeshes is listed twice, once for each of its halves. */
+const std::vector<PostProcessStep>& GetPostProcessSteps();
+
+// ---------------------------------------------------------------------------
+/** Looks up the flags of a profile: "fast", "balanced" or "max", which are
+ *  assimp's TargetRealtime_Fast, _Quality and _MaxQuality presets.
+ *  @return false if there is no such profile
+ */
+bool GetProfileFlags(const std::string& profile, unsigned int& flags);
+
+// ---------------------------------------------------------------------------
+/** Adds and removes steps, given as a comma separated list of step names 
+ *  prefixed with + or -, e.g. "+FlipUVs,-OptimizeMeshes".
+ *  @return false if the list contains an unknown step, in which case 
+ *    error is set
+ */
+bool ApplyStepOverrides(const std::string& overrides, unsigned int& flags, std::string& error);
+
+// ---------------------------------------------------------------------------
+/** Imports a file, running the post processing steps one at a time and 
+ *  recording the wall-clock time each of them takes. The first entry of 
+ *  timings is the import itself.
+ *  @return The scene, or nullptr on failure
+ */
+const aiScene* ReadFileTimed(Assimp::Importer& imp, const char* file, unsigned int flags,
+	std::vector<std::pair<std::string, double> >& timings);
+
+// ---------------------------------------------------------------------------
+/** Like ReadFileTimed(), but imports from memory like 
+ *  Importer::ReadFileFromMemory().
+ *  @param hint File extension of the format, may be empty
+ */
+const aiScene* ReadFileFromMemoryTimed(Assimp::Importer& imp, const void* buffer, size_t length, const char* hint,
+	unsigned int flags, std::vector<std::pair<std::string, double> >& timings);
+
+#endif // INCLUDED_IMPORT_PROFILE
@@ -15,29 +15,56 @@ Licensed under a 3-clause BSD license. See the LICENSE file for more information
 #include <assimp/Exporter.hpp>
 #include <assimp/IOStream.hpp>
 #include <assimp/IOSystem.hpp>
+#include <assimp/DefaultIOSystem.h>
+
+#include <assimp/DefaultLogger.hpp>
+#include <assimp/Exceptional.h>
 
 #include <assimp/defs.h>
 #include <assimp/scene.h>
 
 #include <sstream>
-#include <iostream>
+#include <algorithm>
 #include <limits>
 #include <cassert>
 #include <cstring>
+#include <cstdlib>
 #include <climits>
 #include <set>
+#include <map>
+#include <array>
+#include <atomic>
+#include <deque>
+#include <unordered_map>
+#include <stdexcept>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
 
 #define CURRENT_FORMAT_VERSION 03
 
 #include <memory>
 
+#include "assimp2libgdx.h"
+#include "json_writer.h"
 #include "mesh_splitter.h"
+#include "scene_flattener.h"
+#include "triangle_strips.h"
+#include "vertex_welder.h"
+#include "texture_atlas.h"
+#include "texture_extractor.h"
+#include "scene_utils.h"
+#include "lod_generator.h"
+#include "bounds.h"
+#include "conversion_stats.h"
+#include "export_config.h"
 
 namespace {
 void Assimp2Libgdx(const char*, Assimp::IOSystem*, const aiScene*, const Assimp::ExportProperties*);
 }
 
-Assimp::Exporter::ExportFormatEntry Assimp2Libgdx_desc = Assimp::Exporter::ExportFormatEntry(
+const Assimp::Exporter::ExportFormatEntry Assimp2Libgdx_desc = Assimp::Exporter::ExportFormatEntry(
 	"g3dj",
 	"LibGDX 3D Format (json)",
 	"g3dj",
@@ -46,303 +73,356 @@ Assimp::Exporter::ExportFormatEntry Assimp2Libgdx_desc = Assimp::Exporter::Expor
 
 namespace {
 
+///////////////////////////////////////////////////////////
+// Modified below
+///////////////////////////////////////////////////////////
 
-	// small utility class to simplify serializing the aiScene to Json
-class JSONWriter
+void Write(JSONWriter& out, const aiVector3D& ai) 
 {
+	out.SimpleValue(ai.x);
+	out.SimpleValue(ai.y);
+	out.SimpleValue(ai.z);
+}
 
-public:
-
-	enum {
-		Flag_DoNotIndent = 0x1,
-		Flag_WriteSpecialFloats = 0x2,
-	};
+void Write(JSONWriter& out, const aiQuaternion& ai) 
+{
+	out.SimpleValue(ai.w);
+	out.SimpleValue(ai.x);
+	out.SimpleValue(ai.y);
+	out.SimpleValue(ai.z);
+}
 
-public:
+void Write(JSONWriter& out, const aiColor4D& ai) 
+{
+	out.SimpleValue(ai.r);
+	out.SimpleValue(ai.g);
+	out.SimpleValue(ai.b);
+	out.SimpleValue(ai.a);
+}
 
-	JSONWriter(Assimp::IOStream& out, unsigned int flags = 0u) : out(out), flags(flags)
-	{
-		// make sure that all formatting happens using the standard, C locale and not the user's current locale
-		buff.imbue( std::locale("C") );
-		first = true;
-		doDelimit = true;
+// A transformation decomposed into translation, rotation and scale
+struct Transform
+{
+	explicit Transform(const aiMatrix4x4& transform) {
+		aiMatrix4x4(transform).Decompose(scale, rotation, translation);
 	}
 
-	~JSONWriter()
-	{
-		Flush();
-	}
+	aiVector3D translation;
+	aiQuaternion rotation;
+	aiVector3D scale;
+};
 
-public:
+bool IsNearly(const aiVector3D& a, const aiVector3D& b)
+{
+	const float epsilon = 1e-6f;
+	return std::fabs(a.x - b.x) <= epsilon && std::fabs(a.y - b.y) <= epsilon && std::fabs(a.z - b.z) <= epsilon;
+}
 
-	void Flush()	{
-		const std::string s = buff.str();
-		out.Write(s.c_str(),s.length(),1);
-		buff.clear();
+// Components which are the identity are left out, readers default to it
+void Write(JSONWriter& out, const Transform& ai)
+{
+	if (!IsNearly(ai.translation, aiVector3D(0.0f, 0.0f, 0.0f))) {
+		out.Key("translation");
+		out.StartArray();
+		Write(out, ai.translation);
+		out.EndArray();
 	}
 
-	void PushIndent() {
-		indent += '\t';
+	const float epsilon = 1e-6f;
+	if (std::fabs(std::fabs(ai.rotation.w) - 1.0f) > epsilon || !IsNearly(aiVector3D(ai.rotation.x, ai.rotation.y, ai.rotation.z), aiVector3D(0.0f, 0.0f, 0.0f))) {
+		out.Key("rotation");
+		out.StartArray();
+		Write(out, ai.rotation);
+		out.EndArray();
 	}
 
-	void PopIndent() {
-		indent.erase(indent.end()-1);
+	if (!IsNearly(ai.scale, aiVector3D(1.0f, 1.0f, 1.0f))) {
+		out.Key("scale");
+		out.StartArray();
+		Write(out, ai.scale);
+		out.EndArray();
 	}
+}
 
-	void Key(const std::string& name) {
-		Delimit();
-		NewLine();
-		AddIndentation();
-		doDelimit = false;
-		buff << '\"'+name+"\": ";
-	}
+// Offset matrices of bones, decomposed once. A bone is usually referenced by
+// many parts: every piece of a split mesh, and every level of detail.
+class BoneTransforms
+{
+public:
 
-	template<typename Literal>
-	void SimpleValue(const Literal& s) {
-		if (doDelimit) {
-			Delimit();
-			NewLine();
-			AddIndentation();
+	const Transform& Get(const aiBone& bone) {
+		const std::string name = bone.mName.C_Str();
+		std::map<std::string, std::pair<aiMatrix4x4, Transform> >::iterator it = transforms.find(name);
+		if (it == transforms.end()) {
+			it = transforms.insert(std::make_pair(name, std::make_pair(bone.mOffsetMatrix, Transform(bone.mOffsetMatrix)))).first;
 		}
-		doDelimit = true;
-		LiteralToString(buff, s);
-	}
-
-	void StartObj() {
-		if (doDelimit) {
-			Delimit();
-			NewLine();
-			AddIndentation();
+		else if (!(it->second.first == bone.mOffsetMatrix)) {
+			// a different bone of the same name, rare enough not to be cached
+			others.push_back(Transform(bone.mOffsetMatrix));
+			return others.back();
 		}
-		doDelimit = true;
-		first = true;
-		buff << "{";
-		PushIndent();
+		return it->second.second;
 	}
 
-	void EndObj() {
-		PopIndent();
-		NewLine();
-		AddIndentation();
-		doDelimit = true;
-		first = false;
-		buff << "}";
-	}
+private:
+	std::map<std::string, std::pair<aiMatrix4x4, Transform> > transforms;
+	std::deque<Transform> others;
+};
 
-	void StartArray() {
-		if (doDelimit) {
-			Delimit();
-			NewLine();
-			AddIndentation();
-		}
-		doDelimit = true;
-		first = true;
-		buff << "[";
-		PushIndent();
-	}
+void Write(JSONWriter& out, const aiBone& ai, BoneTransforms& transforms)
+{
+	out.StartObj();
+	
+	//...I think
+	//Or is it the node ID that should be here? 
+	out.Key("node");
+	out.SimpleValue(ai.mName.C_Str()); 
+	
+	Write(out, transforms.Get(ai));
+	
+	out.EndObj();
+}
 
-	void EndArray() {
-		PopIndent();
-		NewLine();
-		AddIndentation();
-		buff << "]";
-		doDelimit = true;
-		first = false;
-	}
+// Faces are written as one part per primitive type, polygons are fanned out into triangles
+enum PartType
+{
+	Part_Points,
+	Part_Lines,
+	Part_Triangles,
+	Part_Count
+};
 
-	void AddIndentation() {
-		if(!(flags & Flag_DoNotIndent)) {
-			buff << indent;
-		}
+const char* const partTypeNames[Part_Count] = { "POINTS", "LINES", "TRIANGLES" };
+
+PartType GetPartType(const aiFace& ai)
+{
+	return ai.mNumIndices == 1 ? Part_Points : ai.mNumIndices == 2 ? Part_Lines : Part_Triangles;
+}
+
+// The part types of a mesh, in the order its parts are written
+std::vector<PartType> GetPartTypes(const aiMesh& ai)
+{
+	bool used[Part_Count] = {};
+	for (unsigned int i = 0; i < ai.mNumFaces; ++i) {
+		used[GetPartType(ai.mFaces[i])] = true;
 	}
-	
-	void NewLine() {
-		buff << std::endl;
+	std::vector<PartType> types;
+	for (unsigned int t = 0; t < Part_Count; ++t) {
+		if (used[t]) {
+			types.push_back(static_cast<PartType>(t));
+		}
 	}
+	return types;
+}
+
+// Part ids must be unique within the model, which mesh names aren't: split meshes share theirs
+std::string PartId(const aiMesh& ai, unsigned int meshIndex, unsigned int part)
+{
+	const std::string id = std::string(ai.mName.C_Str()) + "." + std::to_string(meshIndex);
+	return part ? id + "." + std::to_string(part) : id;
+}
 
-	void Delimit() {
-		if(!first) {
-			buff << ',';
+void WriteIndices(JSONWriter& out, const aiMesh& ai, PartType type)
+{
+	out.StartArray();
+	for (unsigned int i = 0; i < ai.mNumFaces; ++i) {
+		const aiFace& face = ai.mFaces[i];
+		if (GetPartType(face) != type) {
+			continue;
 		}
-		else {
-			buff << ' ';		
-			first = false;
+		if (face.mNumIndices <= 3) {
+			for (unsigned int k = 0; k < face.mNumIndices; ++k) {
+				out.SimpleValue(face.mIndices[k]);
+			}
+			continue;
+		}
+		for (unsigned int k = 1; k + 1 < face.mNumIndices; ++k) {
+			out.SimpleValue(face.mIndices[0]);
+			out.SimpleValue(face.mIndices[k]);
+			out.SimpleValue(face.mIndices[k + 1]);
 		}
 	}
+	out.EndArray();
+}
 
-private:
-
-	//To prevent errors, the generic version is not enabled
-	//Use one of the specializations instead
-	/*
-	template<typename Literal>
-	std::stringstream& LiteralToString(std::stringstream& stream, const Literal& s) {
-		stream << s;
-		return stream;
+// The triangles of a mesh, with polygons fanned as WriteIndices() does
+std::vector<unsigned int> TriangleList(const aiMesh& ai)
+{
+	std::vector<unsigned int> triangles;
+	triangles.reserve(static_cast<size_t>(ai.mNumFaces) * 3);
+	for (unsigned int i = 0; i < ai.mNumFaces; ++i) {
+		const aiFace& face = ai.mFaces[i];
+		for (unsigned int k = 1; k + 1 < face.mNumIndices; ++k) {
+			triangles.push_back(face.mIndices[0]);
+			triangles.push_back(face.mIndices[k]);
+			triangles.push_back(face.mIndices[k + 1]);
+		}
 	}
-	*/
-	
-	std::stringstream& LiteralToString(std::stringstream& stream, const int& s) {
-		stream << s;
-		return stream;
+	return triangles;
+}
+
+// Bounds of the parts of a mesh, in the order they are written
+std::vector<Bounds> ComputePartBounds(const aiMesh& ai)
+{
+	const std::vector<PartType> types = GetPartTypes(ai);
+	if (!ai.HasPositions()) {
+		return std::vector<Bounds>(types.size());
 	}
-	
-	std::stringstream& LiteralToString(std::stringstream& stream, const unsigned int& s) {
-		stream << s;
-		return stream;
+	if (types.size() == 1) {
+		return std::vector<Bounds>(1, ComputeBounds(ai.mVertices, ai.mNumVertices));
 	}
-	
-	std::stringstream& LiteralToString(std::stringstream& stream, const std::string& s) {
-		std::string t;
-		// escape backslashes and single quotes, both would render the JSON invalid if left as is
-		//t.reserve(s.size()); //BZZZZZT
-		for(unsigned int i = 0; i < s.size(); i++) {
-			
-			if (s[i] == '\\' || s[i] == '\'' || s[i] == '\"') {
-				t.push_back('\\');
+	std::vector<Bounds> bounds;
+	std::vector<unsigned int> indices;
+	for (unsigned int t = 0; t < types.size(); ++t) {
+		indices.clear();
+		for (unsigned int i = 0; i < ai.mNumFaces; ++i) {
+			const aiFace& face = ai.mFaces[i];
+			if (GetPartType(face) == types[t]) {
+				indices.insert(indices.end(), face.mIndices, face.mIndices + face.mNumIndices);
 			}
-
-			t.push_back(s[i]);
 		}
-		stream << "\"";
-		stream << t;
-		stream << "\"";
-		return stream;
+		bounds.push_back(ComputeBounds(ai.mVertices, indices.data(), static_cast<unsigned int>(indices.size())));
 	}
+	return bounds;
+}
 
-	std::stringstream& LiteralToString(std::stringstream& stream, const char* s) {
-		std::string t;
-
-		// escape backslashes and single quotes, both would render the JSON invalid if left as is
-		//t.reserve(strlen(s)); //BZZZZZT
-		for(const char* i = s; *i != '\0'; i++) {
-			
-			if (*i == '\\' || *i == '\'' || *i == '\"') {
-				t.push_back('\\');
-			}
-
-			t.push_back(*i);
-		}
-		stream << "\"";
-		stream << t;
-		stream << "\"";
-		return stream;
-	}
-
-	std::stringstream& LiteralToString(std::stringstream& stream, const float& f) {
-		if (!std::numeric_limits<float>::is_iec559) {
-			// on a non IEEE-754 platform, we make no assumptions about the representation or existence
-			// of special floating-point numbers. 
-			stream << f;
-			return stream;
-		}
-		// JSON does not support writing Inf/Nan
-		// [RFC 4672: "Numeric values that cannot be represented as sequences of digits
-		// (such as Infinity and NaN) are not permitted."]
-		// Nevertheless, many parsers will accept the special keywords Infinity, -Infinity and NaN
-		if (std::numeric_limits<float>::infinity() == fabs(f)) {
-			if (flags & Flag_WriteSpecialFloats) {
-				stream << (f < 0 ? "\"-" : "\"") + std::string( "Infinity\"" );
-				return stream;
-			}
-		//  we should print this warning, but we can't - this is called from within a generic assimp exporter, we cannot use cerr
-		//	std::cerr << "warning: cannot represent infinite number literal, substituting 0 instead (use -i flag to enforce Infinity/NaN)" << std::endl;
-			stream << "0.0";
-			return stream;
-		}
-		// f!=f is the most reliable test for NaNs that I know of
-		else if (f != f) {
-			if (flags & Flag_WriteSpecialFloats) {
-				stream << "\"NaN\"";
-				return stream;
-			}
-		//  we should print this warning, but we can't - this is called from within a generic assimp exporter, we cannot use cerr
-		//	std::cerr << "warning: cannot represent infinite number literal, substituting 0 instead (use -i flag to enforce Infinity/NaN)" << std::endl;
-			stream << "0.0";
-			return stream;
-		}
-		stream << f;
-		return stream;
+// A node along with what is written for it
+struct NodeEntry
+{
+	NodeEntry(const aiNode* node, int parent) : node(node), parent(parent), transform(node->mTransformation) {
 	}
 
-private: 
-	Assimp::IOStream& out;
-	std::string indent, newline;
-	std::stringstream buff;
-	bool first;
-	bool doDelimit;
-
-	unsigned int flags;
+	const aiNode* node;
+	int parent; // index of the parent entry, -1 for the root
+	Transform transform;
+	Bounds bounds; // of the node and everything below it, in the node's own space
 };
 
-///////////////////////////////////////////////////////////
-// Modified below
-///////////////////////////////////////////////////////////
-
-void Write(JSONWriter& out, const aiVector3D& ai) 
-{
-	out.SimpleValue(ai.x);
-	out.SimpleValue(ai.y);
-	out.SimpleValue(ai.z);
-}
-
-void Write(JSONWriter& out, const aiQuaternion& ai) 
+// The nodes in the order they are written, depth first. Hierarchies can be
+// thousands of levels deep, so they are walked without recursion.
+std::vector<NodeEntry> FlattenNodes(const aiNode& root, const std::vector<std::vector<Bounds> >& partBounds)
 {
-	out.SimpleValue(ai.w);
-	out.SimpleValue(ai.x);
-	out.SimpleValue(ai.y);
-	out.SimpleValue(ai.z);
-}
+	std::vector<NodeEntry> nodes;
+	std::vector<std::pair<const aiNode*, int> > stack(1, std::make_pair(&root, -1));
+	while (!stack.empty()) {
+		const aiNode* const node = stack.back().first;
+		const int parent = stack.back().second;
+		stack.pop_back();
+		nodes.push_back(NodeEntry(node, parent));
+		for (unsigned int n = node->mNumChildren; n > 0; --n) {
+			stack.push_back(std::make_pair(node->mChildren[n - 1], static_cast<int>(nodes.size()) - 1));
+		}
+	}
 
-void Write(JSONWriter& out, const aiColor4D& ai) 
-{
-	out.SimpleValue(ai.r);
-	out.SimpleValue(ai.g);
-	out.SimpleValue(ai.b);
-	out.SimpleValue(ai.a);
+	// children come after their parents, so going backwards every node is complete before it's added to its parent
+	for (size_t i = nodes.size(); i > 0; --i) {
+		NodeEntry& entry = nodes[i - 1];
+		for (unsigned int n = 0; n < entry.node->mNumMeshes; ++n) {
+			const std::vector<Bounds>& parts = partBounds[entry.node->mMeshes[n]];
+			for (unsigned int p = 0; p < parts.size(); ++p) {
+				entry.bounds.Add(parts[p]);
+			}
+		}
+		if (entry.parent >= 0) {
+			nodes[entry.parent].bounds.Add(TransformBounds(entry.bounds, entry.node->mTransformation));
+		}
+	}
+	return nodes;
 }
 
-void Write(JSONWriter& out, const aiBone& ai)
+void Write(JSONWriter& out, const Bounds& ai)
 {
 	out.StartObj();
-	
-	//...I think
-	//Or is it the node ID that should be here? 
-	out.Key("node");
-	out.SimpleValue(ai.mName.C_Str()); 
-	
-	aiMatrix4x4 transform = ai.mOffsetMatrix;
-	//Decompose
-	aiVector3t<float_t> scale;
-	aiQuaterniont<float_t> rot;
-	aiVector3t<float_t> disp;
-	transform.Decompose(scale, rot, disp);
-	
-	out.Key("translation");
+	out.Key("min");
 	out.StartArray();
-	Write(out, disp);
+	Write(out, ai.min);
 	out.EndArray();
-	
-	out.Key("rotation");
+	out.Key("max");
 	out.StartArray();
-	Write(out, rot);
+	Write(out, ai.max);
 	out.EndArray();
-	
-	out.Key("scale");
+	out.Key("center");
 	out.StartArray();
-	Write(out, scale);
+	Write(out, ai.Center());
 	out.EndArray();
-	
+	out.Key("radius");
+	out.SimpleValue(ai.radius);
 	out.EndObj();
 }
 
-void Write(JSONWriter& out, const aiFace& ai)
+// One vertex component, e.g. the normals, as found in the mesh
+struct VertexStream
 {
-	out.StartArray();
-	for(unsigned int i = 0; i < ai.mNumIndices; ++i) {
-		out.SimpleValue(ai.mIndices[i]);
+	const float* data;
+	unsigned int components; // floats written per vertex
+	unsigned int stride; // floats per vertex in data
+};
+
+template <unsigned int Components>
+void Interleave(const VertexStream& stream, unsigned int first, unsigned int count, float* out, unsigned int vertexSize)
+{
+	const float* in = stream.data + static_cast<size_t>(first) * stream.stride;
+	for (unsigned int i = 0; i < count; ++i, in += stream.stride, out += vertexSize) {
+		for (unsigned int c = 0; c < Components; ++c) {
+			out[c] = in[c];
+		}
+	}
+}
+
+// Writes the vertex components interleaved in the order of the attributes. Rather
+// than going through every component of every vertex, the components are gathered
+// one at a time into a buffer of whole vertices, which is then written in bulk.
+void WriteVertices(JSONWriter& out, const aiMesh& ai)
+{
+	std::vector<VertexStream> streams;
+	if (ai.HasPositions()) {
+		streams.push_back(VertexStream{ &ai.mVertices[0].x, 3, 3 });
+	}
+	if (ai.HasNormals()) {
+		streams.push_back(VertexStream{ &ai.mNormals[0].x, 3, 3 });
+	}
+	for (unsigned int j = 0; j < ai.GetNumColorChannels(); ++j) {
+		streams.push_back(VertexStream{ &ai.mColors[j][0].r, 4, 4 });
+	}
+	if (ai.HasTangentsAndBitangents()) {
+		streams.push_back(VertexStream{ &ai.mTangents[0].x, 3, 3 });
+		streams.push_back(VertexStream{ &ai.mBitangents[0].x, 3, 3 });
+	}
+	for (unsigned int j = 0; j < ai.GetNumUVChannels(); ++j) {
+		streams.push_back(VertexStream{ &ai.mTextureCoords[j][0].x, 2, 3 });
+	}
+
+	unsigned int vertexSize = 0;
+	for (unsigned int s = 0; s < streams.size(); ++s) {
+		vertexSize += streams[s].components;
+	}
+	if (!vertexSize) {
+		return;
+	}
+
+	// a few thousand vertices at a time, so the buffer stays in cache however large the mesh
+	const unsigned int chunk = 4096;
+	std::vector<float> buffer(static_cast<size_t>(chunk) * vertexSize);
+	for (unsigned int first = 0; first < ai.mNumVertices; first += chunk) {
+		const unsigned int count = std::min(chunk, ai.mNumVertices - first);
+		unsigned int offset = 0;
+		for (unsigned int s = 0; s < streams.size(); ++s) {
+			float* const dest = &buffer[offset];
+			switch (streams[s].components) {
+				case 2:
+					Interleave<2>(streams[s], first, count, dest, vertexSize);
+					break;
+				case 3:
+					Interleave<3>(streams[s], first, count, dest, vertexSize);
+					break;
+				default:
+					Interleave<4>(streams[s], first, count, dest, vertexSize);
+					break;
+			}
+			offset += streams[s].components;
+		}
+		out.SimpleValues(buffer.data(), static_cast<size_t>(count) * vertexSize);
 	}
-	out.EndArray();
 }
 
 template <typename Literal>
@@ -358,90 +438,122 @@ void WriteAttribute(JSONWriter& out, const Literal& usage, int size, std::string
 	//out.EndObj();
 }
 
+// Vertices a mesh may have for indices of the given width. 32 bit indices
+// address more vertices than meshes can have, so nothing is split for them.
+unsigned int IndexLimit(unsigned int indexBits)
+{
+	switch (indexBits) {
+	case 32:
+		return std::numeric_limits<unsigned int>::max();
+	case 16:
+		return 1u << 16;
+	default:
+		return 1u << 15;
+	}
+}
+
+// How the index buffers of meshes are written
+struct IndexFormat
+{
+	IndexFormat(unsigned int bits, bool strips) : bits(bits), strips(strips), savedBytes(0) {
+	}
+
+	unsigned int bits;
+	bool strips; // triangles go out as strips where that takes fewer indices
+	std::atomic<unsigned long long> savedBytes; // by strips, from meshes written in parallel
+};
+
+// With 32 bit indices, meshes which fit still get 16 bit ones
+bool NeedsIntIndices(const aiMesh& ai, unsigned int indexBits)
+{
+	return indexBits == 32 && ai.mNumVertices > IndexLimit(16);
+}
+
+// Type of the index buffer for a mesh, the smallest the chosen width allows
+const char* IndexType(const aiMesh& ai, unsigned int indexBits)
+{
+	if (NeedsIntIndices(ai, indexBits)) {
+		return "UNSIGNED_INT";
+	}
+	return indexBits == 15 ? "SHORT" : "UNSIGNED_SHORT";
+}
+
+// The type and indices of the triangle part of a mesh, as a strip if that takes fewer indices
+void WriteTriangles(JSONWriter& out, const aiMesh& ai, IndexFormat& format)
+{
+	const std::vector<unsigned int> triangles = TriangleList(ai);
+	const std::vector<unsigned int> strip = GenerateTriangleStrip(triangles);
+	const bool useStrip = strip.size() < triangles.size();
+	const std::vector<unsigned int>& indices = useStrip ? strip : triangles;
+	if (useStrip) {
+		format.savedBytes += (triangles.size() - strip.size()) * (NeedsIntIndices(ai, format.bits) ? 4 : 2);
+	}
+
+	out.Key("type");
+	out.SimpleValue(useStrip ? "TRIANGLE_STRIP" : partTypeNames[Part_Triangles]);
+	out.Key("indices");
+	out.StartArray();
+	for (size_t i = 0; i < indices.size(); ++i) {
+		out.SimpleValue(indices[i]);
+	}
+	out.EndArray();
+}
+
 //For meshes
-void Write(JSONWriter& out, const aiMesh& ai)
+void Write(JSONWriter& out, const aiMesh& ai, unsigned int meshIndex, const std::vector<Bounds>& bounds, IndexFormat& format)
 {
 	out.StartObj(); 
 	
-	bool writePositions = false;
-	bool writeNormals = false;
-	bool writeColors = false;
-	bool writeTangents = false; 
-	int writeTexCoords = 0;
 	out.Key("attributes");
 	out.StartArray();
 	if (ai.HasPositions()) {
-		writePositions = true;
 		WriteAttribute(out, "POSITION", 3);
 	}
 	if (ai.HasNormals()) {
-		writeNormals = true;
 		WriteAttribute(out, "NORMAL", 3);
 	}
 	if (ai.GetNumColorChannels()) {
-		writeColors = true;
 		WriteAttribute(out, "COLOR", ai.GetNumColorChannels()*4);
 	}
 	if (ai.HasTangentsAndBitangents()) {
-		writeTangents = true;
 		WriteAttribute(out, "TANGENT", 3);
 		WriteAttribute(out, "BINORMAL", 3);
 	}
-	writeTexCoords = ai.GetNumUVChannels()>8?8:ai.GetNumUVChannels();
+	const unsigned int writeTexCoords = ai.GetNumUVChannels()>8?8:ai.GetNumUVChannels();
 	for (unsigned int i = 0; i < writeTexCoords; ++i) {
 		WriteAttribute(out, std::string("TEXCOORD")+std::to_string(i), ai.GetNumUVChannels()*2);
 	}
 	out.EndArray();
+
+	out.Key("indexType");
+	out.SimpleValue(IndexType(ai, format.bits));
 	
 	out.Key("vertices");
 	out.StartArray();
-	for (unsigned int i = 0; i < ai.mNumVertices; ++i) {
-		if (writePositions) Write(out, ai.mVertices[i]);
-		if (writeNormals) Write(out, ai.mNormals[i]);
-		if (writeColors && ai.mColors != nullptr) {
-			for (unsigned int j = 0; j < ai.GetNumColorChannels(); ++j) {
-				Write(out, ai.mColors[j][i]); //I... think? 
-			}
-		}
-		if (writeTangents) {
-			Write(out, ai.mTangents[i]);
-			Write(out, ai.mBitangents[i]);
-		}
-		if (writeTexCoords && ai.mTextureCoords != nullptr) {
-			for (unsigned int j = 0; j < ai.GetNumUVChannels(); ++j) {
-				out.SimpleValue(ai.mTextureCoords[j][i].x);
-				out.SimpleValue(ai.mTextureCoords[j][i].y);
-			}
-		}
-	}
+	WriteVertices(out, ai);
 	out.EndArray();
 	
 	out.Key("parts");
 	out.StartArray();
-	for (unsigned int i = 0; i < ai.mNumFaces; ++i) {
+	const std::vector<PartType> types = GetPartTypes(ai);
+	for (unsigned int i = 0; i < types.size(); ++i) {
 		out.StartObj();
 		out.Key("id");
-		//Name takes the form <meshName> "." <faceNum>
-		out.SimpleValue(std::string(ai.mName.C_Str())+std::string(".")+std::to_string(i)); 
-		out.Key("type");
-		switch(ai.mFaces[i].mNumIndices)
-		{
-			case 1: //Point
-				out.SimpleValue("POINTS");
-				break;
-			case 2: //Line
-				out.SimpleValue("LINES");
-				break;
-			case 3: 
-				out.SimpleValue("TRIANGLES");
-				break;
-			default:
-				out.SimpleValue("TRIANGLE_STRIP");
-				break;
+		out.SimpleValue(PartId(ai, meshIndex, i));
+		if (types[i] == Part_Triangles && format.strips) {
+			WriteTriangles(out, ai, format);
+		}
+		else {
+			out.Key("type");
 			//TODO: Figure out how to get the wireframe attribute from down here
+			out.SimpleValue(partTypeNames[types[i]]);
+			out.Key("indices");
+			WriteIndices(out, ai, types[i]);
+		}
+		if (!bounds[i].IsEmpty()) {
+			out.Key("bounds");
+			Write(out, bounds[i]);
 		}
-		out.Key("indices");
-		Write(out, ai.mFaces[i]);
 		out.EndObj();
 	}
 	out.EndArray();
@@ -449,12 +561,11 @@ void Write(JSONWriter& out, const aiMesh& ai)
 	out.EndObj();
 }
 
-void WriteAsPart(JSONWriter& out, const aiMesh& ai, int id)
+void WriteAsPart(JSONWriter& out, const aiMesh& ai, unsigned int meshIndex, unsigned int part, BoneTransforms& bones)
 {
 	out.StartObj();
 	out.Key("meshpartid");
-	//Name takes the form <meshName> "." <faceNum>
-	out.SimpleValue(std::string(ai.mName.C_Str())+std::string(".")+std::to_string(id));
+	out.SimpleValue(PartId(ai, meshIndex, part));
 	out.Key("materialid");
 	out.SimpleValue(std::to_string(ai.mMaterialIndex));
 	if (ai.HasBones()) {
@@ -466,7 +577,7 @@ void WriteAsPart(JSONWriter& out, const aiMesh& ai, int id)
 		out.Key("bones");
 		out.StartArray();
 		for (unsigned int i = 0; i < ai.mNumBones; ++i) {
-			Write(out, *ai.mBones[i] ); //Why does this segfault
+			Write(out, *ai.mBones[i], bones); //Why does this segfault
 		}
 		out.EndArray();
 	}
@@ -493,305 +604,300 @@ void WriteAsPart(JSONWriter& out, const aiMesh& ai, int id)
 	out.EndObj();
 }
 
-//Recursive function, so we iterate through all nodes
-void Write(JSONWriter& out, const aiNode& ai, aiMesh* meshes, int numMeshes)
+// All parts of a mesh, as referenced from a node
+void WriteAsParts(JSONWriter& out, const aiMesh* const* meshes, unsigned int numMeshes, unsigned int meshIndex, BoneTransforms& bones)
 {
-	out.StartObj();
+	assert(meshIndex < numMeshes);
+	const aiMesh& mesh = *meshes[meshIndex];
+	const unsigned int numParts = static_cast<unsigned int>(GetPartTypes(mesh).size());
+	for (unsigned int part = 0; part < numParts; ++part) {
+		WriteAsPart(out, mesh, meshIndex, part, bones);
+	}
+}
+
+// Everything of a node but its children
+void WriteNodeContents(JSONWriter& out, const NodeEntry& entry, const aiMesh* const* meshes, unsigned int numMeshes,
+	const LodGenerator& lods, BoneTransforms& bones)
+{
+	const aiNode& ai = *entry.node;
 
 	out.Key("id");
 	out.SimpleValue(ai.mName.C_Str());
-	
-	aiMatrix4x4 transform = ai.mTransformation;
-	//Decompose
-	aiVector3t<float_t> scale;
-	aiQuaterniont<float_t> rot;
-	aiVector3t<float_t> disp;
-	transform.Decompose(scale, rot, disp);
-	
-	out.Key("translation");
-	out.StartArray();
-	Write(out, disp);
-	out.EndArray();
-	
-	out.Key("rotation");
-	out.StartArray();
-	Write(out, rot);
-	out.EndArray();
-	
-	out.Key("scale");
-	out.StartArray();
-	Write(out, scale);
-	out.EndArray();
+
+	Write(out, entry.transform);
+
+	// covers the parts of the node and all nodes below it
+	if (!entry.bounds.IsEmpty()) {
+		out.Key("bounds");
+		Write(out, entry.bounds);
+	}
 
 	if(ai.mNumMeshes) {
 		out.Key("parts");
 		out.StartArray();
 		for(unsigned int n = 0; n < ai.mNumMeshes; ++n) {
-			assert(ai.mMeshes[n] < numMeshes);
-			WriteAsPart(out, meshes[ai.mMeshes[n]], n); //?
+			WriteAsParts(out, meshes, numMeshes, ai.mMeshes[n], bones);
 		}
 		out.EndArray();
-	}
-	out.EndObj();
 
-	//As said, recursion
-	if(ai.mNumChildren) {
-		for(unsigned int n = 0; n < ai.mNumChildren; ++n) {
-			Write(out,*ai.mChildren[n],meshes,numMeshes);
+		// each level lists the parts to draw instead of the above; meshes with
+		// fewer levels than others stay at their coarsest
+		unsigned int numLevels = 0;
+		for(unsigned int n = 0; n < ai.mNumMeshes; ++n) {
+			numLevels = std::max(numLevels, static_cast<unsigned int>(lods.GetLevels(ai.mMeshes[n]).size()));
+		}
+		if (numLevels) {
+			out.Key("lods");
+			out.StartArray();
+			for (unsigned int level = 0; level < numLevels; ++level) {
+				out.StartObj();
+				out.Key("parts");
+				out.StartArray();
+				for(unsigned int n = 0; n < ai.mNumMeshes; ++n) {
+					const std::vector<unsigned int>& levels = lods.GetLevels(ai.mMeshes[n]);
+					const unsigned int mesh = levels.empty() ? ai.mMeshes[n] : levels[std::min(level, static_cast<unsigned int>(levels.size()) - 1)];
+					WriteAsParts(out, meshes, numMeshes, mesh, bones);
+				}
+				out.EndArray();
+				out.EndObj();
+			}
+			out.EndArray();
 		}
 	}
 }
 
-std::array<aiString*, 4> Write(JSONWriter& out, const aiMaterial& ai, int d)
+// Writes the hierarchy with children nested in their parents. Nodes are open,
+// with their children array started, until the next node isn't one of theirs.
+void WriteNodes(JSONWriter& out, const std::vector<NodeEntry>& nodes, const aiMesh* const* meshes, unsigned int numMeshes,
+	const LodGenerator& lods, BoneTransforms& bones)
 {
-	aiString* val[4];
-	out.Key("id");
-	out.SimpleValue(std::to_string(d));
-	//Stuff to defer until later
-	bool doBlend = false;
-	float opacity = 1.0;
-	const char* srcBlend = nullptr;
-	const char* destBlend = nullptr;
-	long diffuseDepth = LONG_MIN;
-	aiString* diffusePath = nullptr;
-	long specularDepth = LONG_MIN;
-	aiString* specularPath = nullptr;
-	long bumpDepth = LONG_MIN;
-	aiString* bumpPath = nullptr;
-	long normalDepth = LONG_MIN;
-	aiString* normalPath = nullptr;
-	for (unsigned int i = 0; i < ai.mNumProperties; i++) {
-		const aiMaterialProperty* prop = ai.mProperties[i];
-		std::cout << std::string(prop->mKey.C_Str()) << std::endl;
-		//Took me forever to figure out what was going on before finding that 
-		//the macros weren't just string literals
-		//Don't do unhygenic macros, kids
-		if (!strcmp(prop->mKey.C_Str(), "$clr.diffuse")) {
-			//out.Key("diffuseColor");
-			out.Key("diffuse");
-			out.StartArray();
-			for(unsigned int i = 0; i < 3; ++i) {
-				out.SimpleValue(reinterpret_cast<float*>(prop->mData)[i]);
-			}
+	std::vector<int> open;
+	for (unsigned int i = 0; i < nodes.size(); ++i) {
+		while (!open.empty() && open.back() != nodes[i].parent) {
 			out.EndArray();
-			break;
+			out.EndObj();
+			open.pop_back();
 		}
-		else if (!strcmp(prop->mKey.C_Str(), "$clr.specular")) {
-			//out.Key("specularColor");
-			out.Key("specular");
+
+		out.StartObj();
+		WriteNodeContents(out, nodes[i], meshes, numMeshes, lods, bones);
+		if (nodes[i].node->mNumChildren) {
+			out.Key("children");
 			out.StartArray();
-			for(unsigned int i = 0; i < 3; ++i) {
-				out.SimpleValue(reinterpret_cast<float*>(prop->mData)[i]);
-			}
-			out.EndArray();
-			break;
+			open.push_back(static_cast<int>(i));
 		}
-		else if (!strcmp(prop->mKey.C_Str(), "$clr.ambient")) {
-			//out.Key("ambientColor");
-			out.Key("ambient");
-			out.StartArray();
-			for(unsigned int i = 0; i < 3; ++i) {
-				out.SimpleValue(reinterpret_cast<float*>(prop->mData)[i]);
-			}
-			out.EndArray();
-			break;
+		else {
+			out.EndObj();
 		}
-		else if (!strcmp(prop->mKey.C_Str(), "$clr.emissive")) {
-			//out.Key("emissiveColor");
-			out.Key("emissive");
-			out.StartArray();
-			for(unsigned int i = 0; i < 3; ++i) {
-				out.SimpleValue(reinterpret_cast<float*>(prop->mData)[i]);
-			}
-			out.EndArray();
-			break;
-		}
-		/*
-		else if (!strcmp(prop->mKey.C_Str(), "$mat.twosided")) {
-			out.Key("cullface");
-			bool keepBack = *reinterpret_cast<bool*>(prop->mData);
-			if (keepBack) out.SimpleValue("NONE");
-			else out.SimpleValue("BACK");
-			break;
-		}
-		*/
-		/*
-		else if (!strcmp(prop->mKey.C_Str(), "$mat.blend")) {
-			//Modify blend
-			doBlend = true;
-			if (*reinterpret_cast<unsigned int*>(prop->mData) == aiBlendMode_Additive)
-			{
-				srcBlend = "ONE";
-				destBlend = "ONE";
-			}
-			else
-			{
-				srcBlend = "SRC_ALPHA";
-				doBlend = "ONE_MINUS_SRC_ALPHA";
-			}	
-			break;
-		}
-		*/
-		if (!strcmp(prop->mKey.C_Str(), "$mat.opacity")) {
-			/*
-			doBlend = true;
-			opacity = *reinterpret_cast<float*>(prop->mData);
-			break;
-			*/
-			out.Key("opacity");
-			out.SimpleValue(*reinterpret_cast<float*>(prop->mData));
-			break;
-		}
-		else if (!strcmp(prop->mKey.C_Str(), "$mat.shininess")) {
-			out.Key("shininess");
-			out.SimpleValue(*reinterpret_cast<float*>(prop->mData));
-			break;
-		}
-		else if (!strcmp(prop->mKey.C_Str(), _AI_MATKEY_TEXTURE_BASE)) {
-			long layer = prop->mIndex;
-			unsigned int type = prop->mSemantic;
-			switch (type)
-			{
-				case aiTextureType_DIFFUSE:
-				{
-					if (layer > diffuseDepth)
-					{
-						diffuseDepth = layer;
-						diffusePath = reinterpret_cast<aiString*>(prop->mData);
-					}
-					break;
-				}
-				case aiTextureType_SPECULAR: 
-				{
-					if (layer > specularDepth)
-					{
-						specularDepth = layer;
-						specularPath = reinterpret_cast<aiString*>(prop->mData);
-					}
-					break;
-				}
-				case aiTextureType_HEIGHT:
-				case aiTextureType_DISPLACEMENT:
-				{
-					if (layer > bumpDepth)
-					{
-						bumpDepth = layer;
-						bumpPath = reinterpret_cast<aiString*>(prop->mData);
-					}
-					break;
-				}
-				case aiTextureType_NORMALS:
-				{
-					if (layer > normalDepth)
-					{
-						normalDepth = layer;
-						normalPath = reinterpret_cast<aiString*>(prop->mData);
-					}
-				}
-			}
+	}
+	while (!open.empty()) {
+		out.EndArray();
+		out.EndObj();
+		open.pop_back();
+	}
+}
+
+// Texture paths picked from the properties of a material. Only the
+// topmost layer of every texture type is kept.
+struct MaterialTextures
+{
+	enum {
+		Diffuse,
+		Specular,
+		Bump,
+		Normal,
+		Count
+	};
+
+	MaterialTextures() {
+		for (unsigned int i = 0; i < Count; ++i) {
+			depth[i] = LONG_MIN;
 		}
 	}
-	/*
-	if (doBlend)
-	{
-		out.Key("blended");
-		out.StartObj();
-		out.Key("opacity");
-		out.SimpleValue(opacity);
-		if (srcBlend != nullptr) 
-		{
-			out.Key("source");
-			out.SimpleValue(srcBlend);
+
+	bool Has(unsigned int i) const {
+		return depth[i] != LONG_MIN;
+	}
+
+	long depth[Count];
+	std::string path[Count];
+	// name of the file in the output, which differs from path for embedded textures
+	std::string filename[Count];
+};
+
+const char* const textureTypeNames[MaterialTextures::Count] = { "DIFFUSE", "SPECULAR", "BUMP", "NORMAL" };
+
+MaterialTextures CollectTextures(const aiMaterial& ai)
+{
+	MaterialTextures textures;
+	for (unsigned int i = 0; i < ai.mNumProperties; i++) {
+		const aiMaterialProperty* prop = ai.mProperties[i];
+		if (strcmp(prop->mKey.C_Str(), _AI_MATKEY_TEXTURE_BASE)) {
+			continue;
 		}
-		if (destBlend != nullptr)
+		int slot;
+		switch (prop->mSemantic)
 		{
-			out.Key("destination");
-			out.SimpleValue(destBlend);
+			case aiTextureType_DIFFUSE:
+				slot = MaterialTextures::Diffuse;
+				break;
+			case aiTextureType_SPECULAR:
+				slot = MaterialTextures::Specular;
+				break;
+			case aiTextureType_HEIGHT:
+			case aiTextureType_DISPLACEMENT:
+				slot = MaterialTextures::Bump;
+				break;
+			case aiTextureType_NORMALS:
+				slot = MaterialTextures::Normal;
+				break;
+			default:
+				continue;
 		}
-		out.EndObj();
+		const long layer = prop->mIndex;
+		if (layer > textures.depth[slot]) {
+			textures.depth[slot] = layer;
+			textures.path[slot] = GetMaterialString(*prop);
+		}
+	}
+	return textures;
+}
+
+// Scene-wide table of the texture files referenced by materials. Every file 
+// gets one id, so materials sharing an image refer to the same texture and 
+// the image is only loaded once per model.
+class TextureTable
+{
+public:
+
+	struct Entry {
+		std::string id;
+		std::string filename;
+	};
+
+	const Entry& Add(const std::string& filename) {
+		std::map<std::string, unsigned int>::const_iterator it = index.find(filename);
+		if (it != index.end()) {
+			return entries[it->second];
+		}
+		index[filename] = static_cast<unsigned int>(entries.size());
+		Entry entry;
+		entry.id = "texture" + std::to_string(entries.size());
+		entry.filename = filename;
+		entries.push_back(entry);
+		return entries.back();
+	}
+
+	const Entry& Get(const std::string& filename) const {
+		std::map<std::string, unsigned int>::const_iterator it = index.find(filename);
+		assert(it != index.end());
+		return entries[it->second];
+	}
+
+	const std::vector<Entry>& Entries() const {
+		return entries;
+	}
+
+private:
+	std::map<std::string, unsigned int> index;
+	std::vector<Entry> entries;
+};
+
+typedef void (*MaterialPropertyHandler)(JSONWriter&, const char*, const aiMaterialProperty&);
+
+void WriteColorProperty(JSONWriter& out, const char* key, const aiMaterialProperty& prop)
+{
+	out.Key(key);
+	out.StartArray();
+	for(unsigned int i = 0; i < 3; ++i) {
+		out.SimpleValue(reinterpret_cast<float*>(prop.mData)[i]);
 	}
-	*/
+	out.EndArray();
+}
+
+void WriteFloatProperty(JSONWriter& out, const char* key, const aiMaterialProperty& prop)
+{
+	out.Key(key);
+	out.SimpleValue(*reinterpret_cast<float*>(prop.mData));
+}
+
+void IgnoreProperty(JSONWriter&, const char*, const aiMaterialProperty&)
+{
+}
+
+struct MaterialPropertyEntry
+{
+	MaterialPropertyHandler handler;
+	const char* key; // key in the g3dj material, if any
+};
+
+// Maps assimp material property keys to the code that exports them.
+// Note that the AI_MATKEY_XXX macros aren't just string literals, which is
+// why the plain keys are spelled out here. 
+const std::unordered_map<std::string, MaterialPropertyEntry>& MaterialPropertyTable()
+{
+	static const std::unordered_map<std::string, MaterialPropertyEntry> table = {
+		{ "$clr.diffuse", { WriteColorProperty, "diffuse" } },
+		{ "$clr.specular", { WriteColorProperty, "specular" } },
+		{ "$clr.ambient", { WriteColorProperty, "ambient" } },
+		{ "$clr.emissive", { WriteColorProperty, "emissive" } },
+		{ "$mat.opacity", { WriteFloatProperty, "opacity" } },
+		{ "$mat.shininess", { WriteFloatProperty, "shininess" } },
+		// written from the texture table, see CollectTextures()
+		{ _AI_MATKEY_TEXTURE_BASE, { IgnoreProperty, nullptr } },
+		// $mat.twosided and $mat.blendfunc have no g3dj key: libgdx's G3dModelLoader
+		// reads neither cullface nor blended, it blends materials with an opacity below 1
+	};
+	return table;
+}
+
+void Write(JSONWriter& out, const aiMaterial& ai, int d, const MaterialTextures& textures, const TextureTable& textureTable)
+{
+	out.Key("id");
+	out.SimpleValue(std::to_string(d));
+
+	const std::unordered_map<std::string, MaterialPropertyEntry>& table = MaterialPropertyTable();
+	const bool logging = !Assimp::DefaultLogger::isNullLogger();
+
+	for (unsigned int i = 0; i < ai.mNumProperties; i++) {
+		const aiMaterialProperty* prop = ai.mProperties[i];
+		const std::unordered_map<std::string, MaterialPropertyEntry>::const_iterator it = 
+			table.find(std::string(prop->mKey.C_Str(), prop->mKey.length));
+		if (it == table.end()) {
+			if (logging) {
+				Assimp::DefaultLogger::get()->debug("g3dj: skipping material property " + std::string(prop->mKey.C_Str()));
+			}
+			continue;
+		}
+		it->second.handler(out, it->second.key, *prop);
+	}
+
+	bool hasTextures = false;
+	for (unsigned int i = 0; i < MaterialTextures::Count; ++i) {
+		hasTextures = hasTextures || textures.Has(i);
+	}
+	if (!hasTextures) {
+		return;
+	}
+
 	out.Key("textures");
 	out.StartArray();
-	if (diffuseDepth >= 0)
-	{
+	for (unsigned int i = 0; i < MaterialTextures::Count; ++i) {
+		if (!textures.Has(i)) {
+			continue;
+		}
+		const TextureTable::Entry& texture = textureTable.Get(textures.filename[i]);
 		out.StartObj();
 		out.Key("id");
-		out.SimpleValue(std::to_string(d)+std::string(".diffuse"));
+		out.SimpleValue(texture.id);
 		out.Key("filename");
-		out.SimpleValue(diffusePath->C_Str());
+		out.SimpleValue(texture.filename);
 		out.Key("type");
-		out.SimpleValue("DIFFUSE");
+		out.SimpleValue(textureTypeNames[i]);
 		//TODO: Figure out how in the world we get at texture transllation and scaling
 		out.EndObj();
-		/*
-		out.Key("diffuseTexture");
-		assert(diffusePath != nullptr);
-		out.SimpleValue(diffusePath->C_Str());
-		*/
-		val[0] = diffusePath;
-	}
-	else
-		val[0] = nullptr;
-	if (specularDepth >= 0)
-	{
-		out.StartObj();
-		out.Key("id");
-		out.SimpleValue(std::to_string(d)+std::string(".specular"));
-		out.Key("filename");
-		out.SimpleValue(diffusePath->C_Str());
-		out.Key("type");
-		out.SimpleValue("SPECULAR");
-		//TODO: Figure out how in the world we get at texture transllation and scaling
-		/*
-		out.Key("specularTexture");
-		assert(specularPath != nullptr);
-		out.SimpleValue(specularPath->C_Str());
-		*/
-		val[1] = specularPath;
-	}
-	else
-		val[1] = nullptr;
-	if (bumpDepth >= 0)
-	{
-		out.StartObj();
-		out.Key("id");
-		out.SimpleValue(std::to_string(d)+std::string(".bump"));
-		out.Key("filename");
-		out.SimpleValue(diffusePath->C_Str());
-		out.Key("type");
-		out.SimpleValue("BUMP");
-		//TODO: Figure out how in the world we get at texture transllation and scaling
-		/*
-		out.Key("bumpTexture");
-		assert(bumpPath != nullptr);
-		out.SimpleValue(bumpPath->C_Str());
-		*/
-		val[2] = bumpPath;
-	}
-	else
-		val[2] = nullptr;
-	if (normalDepth >= 0)
-	{
-		out.StartObj();
-		out.Key("id");
-		out.SimpleValue(std::to_string(d)+std::string(".normal"));
-		out.Key("filename");
-		out.SimpleValue(diffusePath->C_Str());
-		out.Key("type");
-		out.SimpleValue("NORMAL");
-		//TODO: Figure out how in the world we get at texture transllation and scaling
-		/*
-		out.Key("normalTexture");
-		assert(normalPath != nullptr);
-		out.SimpleValue(normalPath->C_Str());
-		*/
-		val[3] = normalPath;
-	}
-	else
-		val[3] = nullptr;
+	}
 	out.EndArray();
-	return {val[0], val[1], val[2], val[3]};
 }
 
 void Write(JSONWriter& out, const aiNodeAnim& ai)
@@ -837,7 +943,7 @@ void Write(JSONWriter& out, const aiNodeAnim& ai)
 		if (scaleKeys.find(i->first) != scaleKeys.end()) {
 			out.Key("scaling");
 			out.StartArray();
-			Write(out, rotKeys[i->first]);
+			Write(out, scaleKeys[i->first]);
 			out.EndArray();
 		}
 		out.EndObj();
@@ -855,7 +961,7 @@ void Write(JSONWriter& out, const aiNodeAnim& ai)
 			if (scaleKeys.find(i->first) != scaleKeys.end()) {
 				out.Key("scaling");
 				out.StartArray();
-				Write(out, rotKeys[i->first]);
+				Write(out, scaleKeys[i->first]);
 				out.EndArray();
 			}
 			out.EndObj();
@@ -867,7 +973,7 @@ void Write(JSONWriter& out, const aiNodeAnim& ai)
 			out.StartObj();
 			out.Key("keytime");
 			out.SimpleValue(i->first);
-			out.Key("rotation");
+			out.Key("scaling");
 			out.StartArray();
 			Write(out, i->second);
 			out.EndArray();
@@ -875,6 +981,8 @@ void Write(JSONWriter& out, const aiNodeAnim& ai)
 		}
 	}
 	out.EndArray();
+
+	out.EndObj();
 }
 
 void Write(JSONWriter& out, const aiAnimation& ai)
@@ -906,100 +1014,475 @@ void WriteVersionInfo(JSONWriter& out)
 	out.EndArray();
 }
 
-void Write(JSONWriter& out, const aiScene& ai)
+// Embedded textures are referenced as "*<index>", map those to the files
+// they were extracted to
+std::string TextureFileName(const std::string& path, const TextureExtractor& embedded)
+{
+	if (path.empty() || path[0] != '*') {
+		return path;
+	}
+	const unsigned long index = strtoul(path.c_str() + 1, nullptr, 10);
+	if (index >= embedded.GetNumTextures() || embedded.GetFileName(index).empty()) {
+		return path;
+	}
+	return embedded.GetFileName(index);
+}
+
+// Writes count values at the current position of out with write(fragment, index),
+// as many at once as there are cores. Every value goes into a fragment writer, and
+// fragments are appended in order, so the output is the same as writing them one by
+// one. No more than window values are written ahead of the one to append next, and
+// appended(index) is called right after each value is appended.
+void WriteInParallel(JSONWriter& out, unsigned int count, unsigned int window,
+	const std::function<void (JSONWriter&, unsigned int)>& write,
+	const std::function<void (unsigned int)>& appended)
+{
+	const unsigned int hardware = std::max(1u, std::thread::hardware_concurrency());
+	if (hardware == 1 || count < 2) {
+		for (unsigned int n = 0; n < count; ++n) {
+			write(out, n);
+			appended(n);
+		}
+		return;
+	}
+
+	// out changes while fragments are started, they all start where it is now
+	const JSONWriter origin(out, 0);
+
+	std::vector<std::unique_ptr<JSONWriter> > fragments(count);
+	std::mutex mutex;
+	std::condition_variable done, room;
+	unsigned int next = 0, appending = 0;
+	const std::function<void()> work = [&]() {
+		for (;;) {
+			unsigned int n;
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				room.wait(lock, [&] { return next >= count || next < appending + window; });
+				if (next >= count) {
+					return;
+				}
+				n = next++;
+			}
+			std::unique_ptr<JSONWriter> fragment(new JSONWriter(origin, n));
+			write(*fragment, n);
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				fragments[n] = std::move(fragment);
+			}
+			done.notify_all();
+		}
+	};
+	std::vector<std::thread> workers;
+	for (unsigned int i = 0; i < std::min(hardware, count); ++i) {
+		workers.push_back(std::thread(work));
+	}
+
+	// this thread only appends, in order
+	while (appending < count) {
+		std::unique_ptr<JSONWriter> fragment;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			done.wait(lock, [&] { return fragments[appending] != nullptr; });
+			fragment = std::move(fragments[appending]);
+		}
+		out.Append(*fragment);
+		fragment.reset();
+		appended(appending);
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			++appending;
+		}
+		room.notify_all();
+	}
+	for (unsigned int i = 0; i < workers.size(); ++i) {
+		workers[i].join();
+	}
+}
+
+// With release, every mesh is flushed and deleted right after it is written
+void WriteMeshes(JSONWriter& out, aiScene& ai, const std::vector<std::vector<Bounds> >& partBounds, IndexFormat& format, bool release)
+{
+	ConversionStats::Scope stage("meshes");
+	const unsigned long long start = out.Size();
+	out.Key("meshes");
+	out.StartArray();
+
+	// meshes to be released are only held a few per core at once
+	const unsigned int window = release ? 4 * std::max(1u, std::thread::hardware_concurrency()) : ai.mNumMeshes;
+	WriteInParallel(out, ai.mNumMeshes, window,
+		[&](JSONWriter& fragment, unsigned int n) {
+			Write(fragment,*ai.mMeshes[n],n,partBounds[n],format);
+		},
+		[&](unsigned int n) {
+			if (release) {
+				out.Flush();
+				delete ai.mMeshes[n];
+				ai.mMeshes[n] = nullptr;
+			}
+		});
+
+	out.EndArray();
+	stage.SetBytes(out.Size() - start);
+
+	if (format.strips && !Assimp::DefaultLogger::isNullLogger()) {
+		Assimp::DefaultLogger::get()->info("g3dj: triangle strips saved " + std::to_string(format.savedBytes) + " index bytes");
+	}
+}
+
+// Streaming writes the meshes last, after everything that refers to them,
+// so each of them can go as soon as it is written. Key order doesn't
+// matter to g3dj readers.
+void Write(JSONWriter& out, aiScene& ai, TextureExtractor& embedded, const LodGenerator& lods, IndexFormat& format, bool streaming)
 {
+	// bounds are needed by both meshes and nodes, and nodes may come first
+	std::vector<std::vector<Bounds> > partBounds(ai.mNumMeshes);
+	std::vector<NodeEntry> nodes;
+	{
+		ConversionStats::Scope stage("bounds");
+		for(unsigned int n = 0; n < ai.mNumMeshes; ++n) {
+			partBounds[n] = ComputePartBounds(*ai.mMeshes[n]);
+		}
+		nodes = FlattenNodes(*ai.mRootNode, partBounds);
+	}
+
 	out.StartObj();
 
 	out.Key("version");
 	WriteVersionInfo(out); //Check! 
 	
-	if(ai.HasMeshes()) {
-		out.Key("meshes");
-		out.StartArray();
-		for(unsigned int n = 0; n < ai.mNumMeshes; ++n) {
-			Write(out,*ai.mMeshes[n]);
-		}
-		out.EndArray();
+	if(ai.HasMeshes() && !streaming) {
+		WriteMeshes(out, ai, partBounds, format, false);
 	}
 	
-	//TODO: Take embedded textures out of model and into separate files
-	
+	// embedded textures were written while the meshes were serialized
+	{
+		ConversionStats::Scope stage("embedded textures");
+		embedded.Wait();
+	}
+
 	if(ai.HasMaterials()) {
-		std::set<aiString*> materialNames;
+		ConversionStats::Scope stage("materials");
+		const unsigned long long start = out.Size();
+
+		// build the scene-wide texture table first, so materials can refer to it
+		std::vector<MaterialTextures> materialTextures(ai.mNumMaterials);
+		TextureTable textureTable;
+		for(unsigned int n = 0; n < ai.mNumMaterials; ++n) {
+			materialTextures[n] = CollectTextures(*ai.mMaterials[n]);
+			for (unsigned int i = 0; i < MaterialTextures::Count; ++i) {
+				if (materialTextures[n].Has(i)) {
+					materialTextures[n].filename[i] = TextureFileName(materialTextures[n].path[i], embedded);
+					textureTable.Add(materialTextures[n].filename[i]);
+				}
+			}
+		}
+
 		out.Key("materials");
 		out.StartArray();
 		for(unsigned int n = 0; n < ai.mNumMaterials; ++n) {
 			out.StartObj();
-			std::array<aiString*, 4> values = Write(out,*ai.mMaterials[n],n);
-			if (values[0] != nullptr) materialNames.insert(values[0]);
-			if (values[1] != nullptr) materialNames.insert(values[1]);
-			if (values[2] != nullptr) materialNames.insert(values[2]);
-			if (values[3] != nullptr) materialNames.insert(values[3]);
+			Write(out,*ai.mMaterials[n],n,materialTextures[n],textureTable);
 			out.EndObj();
 		}
 		out.EndArray();
-		// Not until version 0.3 can be loaded into libgdx
-		/*
-		out.Key("texture");
-		out.StartArray();
-		std::set<aiString*>::iterator iter = materialNames.begin();
-		for (unsigned int i = 0; i < materialNames.size(); i++) {
-			aiString* str = *iter++;
-			assert(str != nullptr);
-			out.StartObj();
-			//Assign by index
-			out.Key("id");
-			out.SimpleValue(i);
-			out.Key("filename");
-			out.SimpleValue(str->C_Str());
+
+		if (!textureTable.Entries().empty()) {
+			out.Key("textures");
+			out.StartArray();
+			for (unsigned int i = 0; i < textureTable.Entries().size(); ++i) {
+				const TextureTable::Entry& texture = textureTable.Entries()[i];
+				out.StartObj();
+				out.Key("id");
+				out.SimpleValue(texture.id);
+				out.Key("filename");
+				out.SimpleValue(texture.filename);
+				out.EndObj();
+			}
+			out.EndArray();
 		}
+		stage.SetBytes(out.Size() - start);
+	}
+	
+	{
+		ConversionStats::Scope stage("nodes");
+		const unsigned long long start = out.Size();
+		out.Key("nodes");
+		out.StartArray();
+		BoneTransforms bones;
+		WriteNodes(out, nodes, ai.mMeshes, ai.mNumMeshes, lods, bones);
 		out.EndArray();
-		*/
+		stage.SetBytes(out.Size() - start);
 	}
-		
-	out.Key("nodes");
-	out.StartArray();
-	Write(out,*ai.mRootNode,*ai.mMeshes, ai.mNumMeshes);
-	out.EndArray();
 
 	if(ai.HasAnimations()) {
+		ConversionStats::Scope stage("animations");
+		const unsigned long long start = out.Size();
 		out.Key("animations");
 		out.StartArray();
-		for(unsigned int n = 0; n < ai.mNumAnimations; ++n) {
-			Write(out,*ai.mAnimations[n]);
-		}
+		WriteInParallel(out, ai.mNumAnimations, ai.mNumAnimations,
+			[&](JSONWriter& fragment, unsigned int n) {
+				Write(fragment,*ai.mAnimations[n]);
+			},
+			[](unsigned int) {
+			});
 		out.EndArray();
+		stage.SetBytes(out.Size() - start);
+	}
+
+	if(ai.HasMeshes() && streaming) {
+		out.Flush();
+		WriteMeshes(out, ai, partBounds, format, true);
 	}
 
 	out.EndObj();
 }
 
-
-void Assimp2Libgdx(const char* file, Assimp::IOSystem* io, const aiScene* scene, const Assimp::ExportProperties*) 
+// Runs all export steps on scene, which is modified along the way
+void Export(const char* file, Assimp::IOSystem* io, aiScene* scene, const Assimp2LibgdxOptions& options, bool streaming)
 {
+	std::string error;
+	if (!options.Validate(error)) {
+		throw std::runtime_error(error);
+	}
+
 	std::unique_ptr<Assimp::IOStream> str(io->Open(file,"wt"));
-	assert(str != nullptr);
+	if (!str) {
+		throw std::runtime_error(std::string("could not open output file ") + file);
+	}
+
+	// split meshes so they fit into index buffers of the target width, by default 16 bit signed
+	MeshSplitter splitter;
+	splitter.SetLimit(IndexLimit(options.indexBits));
+
+	// collapse static nodes first, so the atlas can merge the meshes they leave behind
+	if (options.flattenStatic) {
+		ConversionStats::Scope stage("flatten scene");
+		SceneFlattener flattener;
+		flattener.SetVertexLimit(splitter.GetLimit());
+		flattener.Execute(scene);
+	}
+
+	// pack textures into atlases, merged meshes still need to be split
+	if (options.textureAtlasSize > 0) {
+		ConversionStats::Scope stage("texture atlas");
+		TextureAtlasBuilder atlas;
+		atlas.SetMaxSize(options.textureAtlasSize);
+		atlas.SetVertexLimit(splitter.GetLimit());
+		atlas.Execute(scene);
+	}
+
+	// join nearly identical vertices before splitting, fewer vertices need fewer pieces
+	if (options.weldEpsilon > 0.0f) {
+		ConversionStats::Scope stage("weld vertices");
+		VertexWelder welder;
+		welder.SetPositionEpsilon(options.weldEpsilon);
+		welder.SetNormalAngle(options.weldNormalAngle);
+		welder.SetUVEpsilon(options.weldUVEpsilon);
+		welder.Execute(scene);
+	}
+
+	// and, if requested, so that every part fits into the bone palette of one draw call
+	splitter.SetBoneLimit(options.maxBonesPerPart);
+	{
+		// meshes are replaced by their pieces one at a time, so this needs at most one mesh extra
+		ConversionStats::Scope stage("split meshes");
+		splitter.Execute(scene);
+	}
+
+	// levels of detail only ever drop vertices, so they need no further splitting
+	LodGenerator lods;
+	lods.SetLevels(options.lodLevels);
+	lods.SetRatio(options.lodRatio);
+	lods.SetMaxError(options.lodMaxError);
+	{
+		ConversionStats::Scope stage("levels of detail");
+		lods.Execute(scene);
+	}
 	
-	// get a copy of the scene so we can modify it
-	aiScene* scenecopy_tmp;
-	aiCopyScene(scene, &scenecopy_tmp);
+	// embedded textures go next to the output file, start writing them right away
+	const std::string path = file;
+	const std::string::size_type sep = path.find_last_of("/\\");
+	TextureExtractor embedded;
+	embedded.Start(scene, io, sep == std::string::npos ? std::string() : path.substr(0, sep + 1));
+
+	unsigned int flags = 0u;
+	if (!options.indent) {
+		flags |= JSONWriter::Flag_DoNotIndent;
+	}
+	if (options.specialFloats) {
+		flags |= JSONWriter::Flag_WriteSpecialFloats;
+	}
+	JSONWriter s(*str,flags);
+	IndexFormat format(options.indexBits, options.triangleStrips);
+	Write(s,*scene,embedded,lods,format,streaming);
+
+	ConversionStats::Scope stage("flush");
+	s.Flush();
+	stage.SetBytes(s.Size());
+}
+
+// Writes into buffers held by the BufferIOSystem it came from
+class BufferIOStream : public Assimp::IOStream
+{
+public:
+	explicit BufferIOStream(const std::shared_ptr<std::vector<char> >& data) : data(data), position(0) {
+	}
+
+	size_t Read(void* buffer, size_t size, size_t count) {
+		if (!size) {
+			return 0;
+		}
+		count = std::min(count, (data->size() - position) / size);
+		std::copy(data->begin() + position, data->begin() + position + size * count, static_cast<char*>(buffer));
+		position += size * count;
+		return count;
+	}
+
+	size_t Write(const void* buffer, size_t size, size_t count) {
+		const char* const bytes = static_cast<const char*>(buffer);
+		const size_t overlap = std::min(size * count, data->size() - position);
+		std::copy(bytes, bytes + overlap, data->begin() + position);
+		data->insert(data->end(), bytes + overlap, bytes + size * count);
+		position += size * count;
+		return count;
+	}
+
+	aiReturn Seek(size_t offset, aiOrigin origin) {
+		const size_t base = origin == aiOrigin_CUR ? position : origin == aiOrigin_END ? data->size() : 0;
+		if (base + offset > data->size()) {
+			return aiReturn_FAILURE;
+		}
+		position = base + offset;
+		return aiReturn_SUCCESS;
+	}
+
+	size_t Tell() const {
+		return position;
+	}
+
+	size_t FileSize() const {
+		return data->size();
+	}
+
+	void Flush() {
+	}
+
+private:
+	std::shared_ptr<std::vector<char> > data;
+	size_t position;
+};
+
+// Keeps the files written through it in memory, for Assimp2LibgdxExportToBuffer()
+class BufferIOSystem : public Assimp::IOSystem
+{
+public:
+	bool Exists(const char* file) const {
+		std::lock_guard<std::mutex> lock(mutex);
+		return files.count(file) != 0;
+	}
+
+	char getOsSeparator() const {
+		return '/';
+	}
+
+	Assimp::IOStream* Open(const char* file, const char* mode) {
+		std::lock_guard<std::mutex> lock(mutex);
+		if (strchr(mode, 'w')) {
+			files[file] = std::make_shared<std::vector<char> >();
+		}
+		const auto it = files.find(file);
+		return it == files.end() ? nullptr : new BufferIOStream(it->second);
+	}
+
+	void Close(Assimp::IOStream* stream) {
+		delete stream;
+	}
+
+	// the contents of file, moved out of this
+	std::vector<char> Take(const std::string& file) {
+		std::lock_guard<std::mutex> lock(mutex);
+		std::vector<char> data;
+		const auto it = files.find(file);
+		if (it != files.end()) {
+			data.swap(*it->second);
+			files.erase(it);
+		}
+		return data;
+	}
+
+	std::vector<std::string> GetFileNames() const {
+		std::lock_guard<std::mutex> lock(mutex);
+		std::vector<std::string> names;
+		for (const auto& file : files) {
+			names.push_back(file.first);
+		}
+		return names;
+	}
 
+private:
+	mutable std::mutex mutex;
+	std::map<std::string, std::shared_ptr<std::vector<char> > > files;
+};
+
+// Copies scene and runs all export steps on the copy
+void ExportCopy(const char* file, Assimp::IOSystem* io, const aiScene* scene, const Assimp2LibgdxOptions& options)
+{
+	aiScene* copy;
+	{
+		ConversionStats::Scope stage("copy scene");
+		aiCopyScene(scene, &copy);
+	}
+	std::unique_ptr<aiScene> owned(copy);
+	Export(file, io, copy, options, false);
+}
+
+void Assimp2Libgdx(const char* file, Assimp::IOSystem* io, const aiScene* scene, const Assimp::ExportProperties* props) 
+{
 	try {
-		// split meshes so they fit into a 16 bit signed index buffer
-		MeshSplitter splitter;
-		splitter.SetLimit(1 << 15);
-		splitter.Execute(scenecopy_tmp);
-		
-		// XXX Flag_WriteSpecialFloats is turned on by default, right now we don't have a configuration interface for exporters
-		JSONWriter s(*str,JSONWriter::Flag_WriteSpecialFloats);
-		Write(s,*scenecopy_tmp);
+		ExportCopy(file, io, scene, props ? Assimp2LibgdxOptions(*props) : Assimp2LibgdxOptions());
 	}
 	catch(const std::exception &exc) {
-		std::cerr << exc.what();
-		aiFreeScene(scenecopy_tmp);
-		throw;
+		// Assimp::Exporter only catches its own error type, and hands its text to GetErrorString()
+		throw DeadlyExportError(exc.what());
 	}
-	aiFreeScene(scenecopy_tmp);
 }
 
 } // 
+
+// ------------------------------------------------------------------------------------------------
+void Assimp2LibgdxExport(const aiScene* scene, const char* file, Assimp::IOSystem* io, const Assimp2LibgdxOptions& options)
+{
+	Assimp::DefaultIOSystem defaultIO;
+	ExportCopy(file, io ? io : &defaultIO, scene, options);
+}
+
+// ------------------------------------------------------------------------------------------------
+void Assimp2LibgdxExportInPlace(aiScene* scene, const char* file, Assimp::IOSystem* io, const Assimp2LibgdxOptions& options)
+{
+	std::unique_ptr<aiScene> owned(scene);
+	Assimp::DefaultIOSystem defaultIO;
+	Export(file, io ? io : &defaultIO, scene, options, true);
+}
+
+// ------------------------------------------------------------------------------------------------
+void Assimp2LibgdxExportToBuffer(const aiScene* scene, const Assimp2LibgdxOptions& options, std::string& json,
+	std::vector<Assimp2LibgdxFile>* textures)
+{
+	// textures are written next to the model, so without a directory their names are the ones referenced
+	static const char* const model = "model.g3dj";
+	BufferIOSystem io;
+	ExportCopy(model, &io, scene, options);
+
+	const std::vector<char> data = io.Take(model);
+	json.assign(data.begin(), data.end());
+	if (textures) {
+		const std::vector<std::string> names = io.GetFileNames();
+		for (unsigned int i = 0; i < names.size(); ++i) {
+			Assimp2LibgdxFile file;
+			file.name = names[i];
+			file.data = io.Take(names[i]);
+			textures->push_back(file);
+		}
+	}
+}
@@ -0,0 +1,457 @@
+/*
+Assimp2Libgdx
+Copyright (c) 2017, Eugene Wang
+
+Licensed under a 3-clause BSD license. See the LICENSE file for more information.
+Based on Assimp2Json, whose license is below: 
+*/
+/*
+Assimp2Json
+Copyright (c) 2011, Alexander C. Gessler
+
+Licensed under a 3-clause BSD license. See the LICENSE file for more information.
+*/
+
+#ifndef INCLUDED_JSON_WRITER
+#define INCLUDED_JSON_WRITER
+
+#include <assimp/IOStream.hpp>
+
+#include <sstream>
+#include <string>
+#include <limits>
+#include <locale>
+#include <cmath>
+#include <cstdio>
+#include <clocale>
+
+// ---------------------------------------------------------------------------
+/** Small utility class to simplify serializing the aiScene to Json. Output
+ *  is buffered until Flush() or destruction.
+ *
+ *  Parts of a document can be written independently, e.g. on other threads,
+ *  by fragment writers, which are then appended to the writer of the
+ *  document in order. The result is the same as writing all of it to the
+ *  document's writer.
+ */
+class JSONWriter
+{
+
+public:
+
+	enum {
+		Flag_DoNotIndent = 0x1,
+		Flag_WriteSpecialFloats = 0x2,
+	};
+
+public:
+
+	JSONWriter(Assimp::IOStream& out, unsigned int flags = 0u) : out(&out), depth(0), flags(flags), flushed(0)
+	{
+		// make sure that all formatting happens using the standard, C locale and not the user's current locale
+		buff.imbue( std::locale("C") );
+		first = true;
+		doDelimit = true;
+	}
+
+	// fragment writer for the item-th value written at the current position of document,
+	// which must stay there until all fragments are appended; the values must be complete
+	JSONWriter(const JSONWriter& document, unsigned int item)
+		: out(nullptr), indent(document.indent), depth(document.depth), first(item ? false : document.first)
+		, doDelimit(item ? true : document.doDelimit), flags(document.flags), flushed(0)
+	{
+		buff.imbue( std::locale("C") );
+	}
+
+	~JSONWriter()
+	{
+		Flush();
+	}
+
+public:
+
+	void Flush()	{
+		if (!out) {
+			return;
+		}
+		const std::string s = buff.str();
+		out->Write(s.c_str(),s.length(),1);
+		flushed += s.length();
+		buff.str(std::string());
+	}
+
+	// adds what a fragment writer wrote, which is emptied
+	void Append(JSONWriter& fragment) {
+		const std::string s = fragment.buff.str();
+		buff.write(s.data(), static_cast<std::streamsize>(s.size()));
+		fragment.buff.str(std::string());
+		first = fragment.first;
+		doDelimit = fragment.doDelimit;
+	}
+
+	// number of bytes written so far, flushed or not
+	unsigned long long Size() {
+		return flushed + static_cast<unsigned long long>(buff.tellp());
+	}
+
+	// indentation stops growing past MaxIndent levels, so deeply nested
+	// node hierarchies don't make the file quadratic in their depth
+	void PushIndent() {
+		if (++depth <= MaxIndent) {
+			indent += '\t';
+		}
+	}
+
+	void PopIndent() {
+		if (depth-- <= MaxIndent) {
+			indent.erase(indent.end()-1);
+		}
+	}
+
+	void Key(const std::string& name) {
+		Delimit();
+		NewLine();
+		AddIndentation();
+		doDelimit = false;
+		buff << '\"'+name+"\": ";
+	}
+
+	template<typename Literal>
+	void SimpleValue(const Literal& s) {
+		if (doDelimit) {
+			Delimit();
+			NewLine();
+			AddIndentation();
+		}
+		doDelimit = true;
+		LiteralToString(buff, s);
+	}
+
+	// writes floats as consecutive values, the same as calling SimpleValue()
+	// on each, but formatted in bulk rather than through the stream
+	void SimpleValues(const float* values, size_t count) {
+		if (!std::numeric_limits<float>::is_iec559) {
+			for (size_t i = 0; i < count; ++i) {
+				SimpleValue(values[i]);
+			}
+			return;
+		}
+
+		std::string text;
+		text.reserve(count * (16 + indent.size()));
+		char number[32];
+		for (size_t i = 0; i < count; ++i) {
+			if (doDelimit) {
+				text += first ? ' ' : ',';
+				first = false;
+				text += '\n';
+				if (!(flags & Flag_DoNotIndent)) {
+					text += indent;
+				}
+			}
+			doDelimit = true;
+
+			const float f = values[i];
+			if (std::numeric_limits<float>::infinity() == std::fabs(f)) {
+				text += !(flags & Flag_WriteSpecialFloats) ? "0.0" : f < 0 ? "\"-Infinity\"" : "\"Infinity\"";
+				continue;
+			}
+			if (f != f) {
+				text += flags & Flag_WriteSpecialFloats ? "\"NaN\"" : "0.0";
+				continue;
+			}
+			text.append(number, FormatFloat(f, number));
+		}
+		buff.write(text.data(), static_cast<std::streamsize>(text.size()));
+	}
+
+	void StartObj() {
+		if (doDelimit) {
+			Delimit();
+			NewLine();
+			AddIndentation();
+		}
+		doDelimit = true;
+		first = true;
+		buff << "{";
+		PushIndent();
+	}
+
+	void EndObj() {
+		PopIndent();
+		NewLine();
+		AddIndentation();
+		doDelimit = true;
+		first = false;
+		buff << "}";
+	}
+
+	void StartArray() {
+		if (doDelimit) {
+			Delimit();
+			NewLine();
+			AddIndentation();
+		}
+		doDelimit = true;
+		first = true;
+		buff << "[";
+		PushIndent();
+	}
+
+	void EndArray() {
+		PopIndent();
+		NewLine();
+		AddIndentation();
+		buff << "]";
+		doDelimit = true;
+		first = false;
+	}
+
+	void AddIndentation() {
+		if(!(flags & Flag_DoNotIndent)) {
+			buff << indent;
+		}
+	}
+	
+	void NewLine() {
+		buff << std::endl;
+	}
+
+	void Delimit() {
+		if(!first) {
+			buff << ',';
+		}
+		else {
+			buff << ' ';		
+			first = false;
+		}
+	}
+
+private:
+
+	// -------------------------------------------------------------------
+	// Formats a finite float like operator<< with the default precision
+	// does, which is printf's %.6g. The six digits are rounded in double
+	// precision, which only falls back to snprintf when that is too close
+	// to call; printf rounds the exact value. Returns the length.
+	static size_t FormatFloat(float f, char* out) {
+		static const double powers[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+			1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+		char* p = out;
+		if (std::signbit(f)) {
+			*p++ = '-';
+		}
+		const double value = std::fabs(static_cast<double>(f));
+		if (value == 0.0) {
+			*p++ = '0';
+			return p - out;
+		}
+
+		// the digits, as an integer from 100000 to 999999, and the exponent of the first
+		int exponent = static_cast<int>(std::floor(std::log10(value)));
+		double scaled = 0.0;
+		for (int attempt = 0; attempt < 2; ++attempt) {
+			scaled = value;
+			int k = 5 - exponent;
+			for (; k > 22; k -= 22) {
+				scaled *= 1e22;
+			}
+			for (; k < -22; k += 22) {
+				scaled /= 1e22;
+			}
+			scaled = k >= 0 ? scaled * powers[k] : scaled / powers[-k];
+			if (scaled < 99999.5) {
+				--exponent;
+			}
+			else if (scaled >= 999999.5) {
+				++exponent;
+			}
+			else {
+				break;
+			}
+		}
+		const double fraction = scaled - std::floor(scaled);
+		if (scaled < 99999.5 || scaled >= 999999.5 || std::fabs(fraction - 0.5) < 1e-6) {
+			return FormatFloatSlow(f, out);
+		}
+		unsigned long digits = static_cast<unsigned long>(scaled + 0.5);
+		if (digits == 1000000) {
+			digits = 100000;
+			++exponent;
+		}
+
+		char d[6];
+		for (int i = 5; i >= 0; --i) {
+			d[i] = static_cast<char>('0' + digits % 10);
+			digits /= 10;
+		}
+		int last = 5;
+		while (last > 0 && d[last] == '0') {
+			--last;
+		}
+
+		if (exponent >= -4 && exponent < 6) {
+			if (exponent < 0) {
+				*p++ = '0';
+				*p++ = '.';
+				for (int i = -1; i > exponent; --i) {
+					*p++ = '0';
+				}
+				for (int i = 0; i <= last; ++i) {
+					*p++ = d[i];
+				}
+				return p - out;
+			}
+			for (int i = 0; i <= exponent; ++i) {
+				*p++ = d[i];
+			}
+			if (last > exponent) {
+				*p++ = '.';
+				for (int i = exponent + 1; i <= last; ++i) {
+					*p++ = d[i];
+				}
+			}
+			return p - out;
+		}
+
+		*p++ = d[0];
+		if (last > 0) {
+			*p++ = '.';
+			for (int i = 1; i <= last; ++i) {
+				*p++ = d[i];
+			}
+		}
+		*p++ = 'e';
+		*p++ = exponent < 0 ? '-' : '+';
+		const int e = std::abs(exponent);
+		if (e >= 100) {
+			*p++ = static_cast<char>('0' + e / 100);
+		}
+		*p++ = static_cast<char>('0' + e / 10 % 10);
+		*p++ = static_cast<char>('0' + e % 10);
+		return p - out;
+	}
+
+	static size_t FormatFloatSlow(float f, char* out) {
+		const int length = snprintf(out, 32, "%.*g", 6, static_cast<double>(f));
+
+		// snprintf follows the global locale, while the stream is always imbued with "C"
+		const char point = *localeconv()->decimal_point;
+		for (int c = 0; c < length; ++c) {
+			if (out[c] == point) {
+				out[c] = '.';
+			}
+		}
+		return static_cast<size_t>(length);
+	}
+
+	//To prevent errors, the generic version is not enabled
+	//Use one of the specializations instead
+	/*
+	template<typename Literal>
+	std::stringstream& LiteralToString(std::stringstream& stream, const Literal& s) {
+		stream << s;
+		return stream;
+	}
+	*/
+	
+	std::stringstream& LiteralToString(std::stringstream& stream, const int& s) {
+		stream << s;
+		return stream;
+	}
+	
+	std::stringstream& LiteralToString(std::stringstream& stream, const unsigned int& s) {
+		stream << s;
+		return stream;
+	}
+	
+	std::stringstream& LiteralToString(std::stringstream& stream, const std::string& s) {
+		std::string t;
+		// escape backslashes and single quotes, both would render the JSON invalid if left as is
+		//t.reserve(s.size()); //BZZZZZT
+		for(unsigned int i = 0; i < s.size(); i++) {
+			
+			if (s[i] == '\\' || s[i] == '\'' || s[i] == '\"') {
+				t.push_back('\\');
+			}
+
+			t.push_back(s[i]);
+		}
+		stream << "\"";
+		stream << t;
+		stream << "\"";
+		return stream;
+	}
+
+	std::stringstream& LiteralToString(std::stringstream& stream, const char* s) {
+		std::string t;
+
+		// escape backslashes and single quotes, both would render the JSON invalid if left as is
+		//t.reserve(strlen(s)); //BZZZZZT
+		for(const char* i = s; *i != '\0'; i++) {
+			
+			if (*i == '\\' || *i == '\'' || *i == '\"') {
+				t.push_back('\\');
+			}
+
+			t.push_back(*i);
+		}
+		stream << "\"";
+		stream << t;
+		stream << "\"";
+		return stream;
+	}
+
+	std::stringstream& LiteralToString(std::stringstream& stream, const float& f) {
+		if (!std::numeric_limits<float>::is_iec559) {
+			// on a non IEEE-754 platform, we make no assumptions about the representation or existence
+			// of special floating-point numbers. 
+			stream << f;
+			return stream;
+		}
+		// JSON does not support writing Inf/Nan
+		// [RFC 4672: "Numeric values that cannot be represented as sequences of digits
+		// (such as Infinity and NaN) are not permitted."]
+		// Nevertheless, many parsers will accept the special keywords Infinity, -Infinity and NaN
+		if (std::numeric_limits<float>::infinity() == std::fabs(f)) {
+			if (flags & Flag_WriteSpecialFloats) {
+				stream << (f < 0 ? "\"-" : "\"") + std::string( "Infinity\"" );
+				return stream;
+			}
+		//  we should print this warning, but we can't - this is called from within a generic assimp exporter, we cannot use cerr
+		//	std::cerr << "warning: cannot represent infinite number literal, substituting 0 instead (use -i flag to enforce Infinity/NaN)" << std::endl;
+			stream << "0.0";
+			return stream;
+		}
+		// f!=f is the most reliable test for NaNs that I know of
+		else if (f != f) {
+			if (flags & Flag_WriteSpecialFloats) {
+				stream << "\"NaN\"";
+				return stream;
+			}
+		//  we should print this warning, but we can't - this is called from within a generic assimp exporter, we cannot use cerr
+		//	std::cerr << "warning: cannot represent infinite number literal, substituting 0 instead (use -i flag to enforce Infinity/NaN)" << std::endl;
+			stream << "0.0";
+			return stream;
+		}
+		char number[32];
+		stream.write(number, static_cast<std::streamsize>(FormatFloat(f, number)));
+		return stream;
+	}
+
+private: 
+	Assimp::IOStream* out; // NULL for fragments
+	static const unsigned int MaxIndent = 64;
+
+	std::string indent, newline;
+	unsigned int depth;
+	std::stringstream buff;
+	bool first;
+	bool doDelimit;
+
+	unsigned int flags;
+	unsigned long long flushed;
+};
+
+#endif // INCLUDED_JSON_WRITER
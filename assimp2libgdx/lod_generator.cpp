@@ -0,0 +1,560 @@
+/*
+Assimp2Libgdx
+Copyright (c) 2017, Eugene Wang
+
+Licensed under a 3-clause BSD license. See the LICENSE file for more information.
+*/
+
+#include "lod_generator.h"
+
+#include <assimp/scene.h>
+#include <assimp/DefaultLogger.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+
+namespace {
+
+// ------------------------------------------------------------------------------------------------
+// Symmetric 4x4 matrix summing the squared distances to a set of planes
+struct Quadric
+{
+	Quadric() {
+		std::fill(m, m + 10, 0.0);
+	}
+
+	// plane a*x + b*y + c*z + d = 0 with unit normal, weighted
+	Quadric(double a, double b, double c, double d, double weight) {
+		m[0] = a * a * weight; m[1] = a * b * weight; m[2] = a * c * weight; m[3] = a * d * weight;
+		m[4] = b * b * weight; m[5] = b * c * weight; m[6] = b * d * weight;
+		m[7] = c * c * weight; m[8] = c * d * weight;
+		m[9] = d * d * weight;
+	}
+
+	Quadric& operator += (const Quadric& o) {
+		for (unsigned int i = 0; i < 10; ++i) {
+			m[i] += o.m[i];
+		}
+		return *this;
+	}
+
+	double Error(const aiVector3D& v) const {
+		const double x = v.x, y = v.y, z = v.z;
+		return m[0] * x * x + 2 * m[1] * x * y + 2 * m[2] * x * z + 2 * m[3] * x
+			+ m[4] * y * y + 2 * m[5] * y * z + 2 * m[6] * y
+			+ m[7] * z * z + 2 * m[8] * z
+			+ m[9];
+	}
+
+	double m[10];
+};
+
+// ------------------------------------------------------------------------------------------------
+// Moving vertex from onto vertex to
+struct Collapse
+{
+	double cost;
+	unsigned int from, to;
+
+	// ties are broken by index, so the result does not depend on the sort implementation
+	bool operator < (const Collapse& o) const {
+		if (cost != o.cost) {
+			return cost < o.cost;
+		}
+		return from < o.from;
+	}
+};
+
+// ------------------------------------------------------------------------------------------------
+aiVector3D TriangleNormal(const aiVector3D& a, const aiVector3D& b, const aiVector3D& c)
+{
+	return (b - a) ^ (c - a);
+}
+
+// ------------------------------------------------------------------------------------------------
+// Edge collapse on the triangles of one mesh. Levels are snapshots of the
+// same simplification, taken as it passes each triangle budget.
+//
+// Rather than keeping all candidate collapses in a priority queue, which
+// is dominated by cache misses on large meshes, collapses run in passes:
+// each pass sorts the cheapest collapse of every vertex, and applies them
+// in order as long as they don't touch a region changed earlier in the pass.
+class Simplifier
+{
+public:
+
+	explicit Simplifier(const aiMesh& mesh);
+
+	// Index lists of the levels, as many as could be reached
+	std::vector<std::vector<unsigned int> > Run(unsigned int levels, float ratio, float maxError);
+
+private:
+
+	bool Contains(unsigned int tri, unsigned int v) const {
+		return indices[tri * 3] == v || indices[tri * 3 + 1] == v || indices[tri * 3 + 2] == v;
+	}
+
+	void Neighbours(unsigned int v, std::vector<unsigned int>& result) const;
+	bool Pass(unsigned int target, double limit);
+	bool IsValid(unsigned int from, unsigned int to) const;
+	void Apply(unsigned int from, unsigned int to);
+	std::vector<unsigned int> Snapshot() const;
+
+	const aiMesh& mesh;
+	std::vector<unsigned int> indices;
+	std::vector<bool> alive;
+	unsigned int aliveCount;
+
+	std::vector<std::vector<unsigned int> > triangles; // per vertex, may list dead triangles
+	std::vector<Quadric> quadrics;
+	std::vector<bool> locked;
+	std::vector<bool> removed;
+
+	// scratch space, reused by every pass and collapse
+	std::vector<Collapse> candidates;
+	std::vector<bool> touched;
+	mutable std::vector<unsigned int> fromNeighbours, toNeighbours, common;
+};
+
+// ------------------------------------------------------------------------------------------------
+Simplifier :: Simplifier(const aiMesh& mesh)
+	: mesh(mesh), aliveCount(0)
+{
+	const unsigned int numVertices = mesh.mNumVertices;
+	indices.reserve(mesh.mNumFaces * 3);
+	for (unsigned int i = 0; i < mesh.mNumFaces; ++i) {
+		const aiFace& face = mesh.mFaces[i];
+		indices.insert(indices.end(), face.mIndices, face.mIndices + 3);
+	}
+	aliveCount = static_cast<unsigned int>(indices.size() / 3);
+	alive.assign(aliveCount, true);
+
+	triangles.resize(numVertices);
+	quadrics.resize(numVertices);
+	locked.assign(numVertices, false);
+	removed.assign(numVertices, false);
+
+	// vertices sharing a position differ in normals or texture coordinates, moving
+	// one of them would tear the surface open along that seam
+	struct PositionHash {
+		size_t operator()(const aiVector3D& v) const {
+			unsigned int bits[3];
+			memcpy(bits, &v.x, sizeof(float));
+			memcpy(bits + 1, &v.y, sizeof(float));
+			memcpy(bits + 2, &v.z, sizeof(float));
+			return (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u);
+		}
+	};
+	std::unordered_map<aiVector3D, unsigned int, PositionHash> positions;
+	for (unsigned int v = 0; v < numVertices; ++v) {
+		const std::pair<std::unordered_map<aiVector3D, unsigned int, PositionHash>::iterator, bool> it =
+			positions.insert(std::make_pair(mesh.mVertices[v], v));
+		if (!it.second) {
+			locked[v] = locked[it.first->second] = true;
+		}
+	}
+
+	// and moving vertices on open borders would shrink the mesh
+	std::unordered_map<unsigned long long, unsigned int> edges;
+	for (unsigned int t = 0; t < aliveCount; ++t) {
+		for (unsigned int k = 0; k < 3; ++k) {
+			const unsigned int a = indices[t * 3 + k], b = indices[t * 3 + (k + 1) % 3];
+			++edges[(static_cast<unsigned long long>(std::min(a, b)) << 32) | std::max(a, b)];
+		}
+	}
+	for (std::unordered_map<unsigned long long, unsigned int>::const_iterator it = edges.begin(); it != edges.end(); ++it) {
+		if (it->second == 1) {
+			locked[static_cast<unsigned int>(it->first >> 32)] = true;
+			locked[static_cast<unsigned int>(it->first & 0xffffffffu)] = true;
+		}
+	}
+
+	// every vertex starts out with the planes of its triangles, weighted by area
+	for (unsigned int t = 0; t < aliveCount; ++t) {
+		const unsigned int* const tri = &indices[t * 3];
+		const aiVector3D n = TriangleNormal(mesh.mVertices[tri[0]], mesh.mVertices[tri[1]], mesh.mVertices[tri[2]]);
+		const double length = n.Length();
+		if (length > 0) {
+			const double a = n.x / length, b = n.y / length, c = n.z / length;
+			const aiVector3D& p = mesh.mVertices[tri[0]];
+			const Quadric q(a, b, c, -(a * p.x + b * p.y + c * p.z), length * 0.5);
+			for (unsigned int k = 0; k < 3; ++k) {
+				quadrics[tri[k]] += q;
+			}
+		}
+		for (unsigned int k = 0; k < 3; ++k) {
+			triangles[tri[k]].push_back(t);
+		}
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+void Simplifier :: Neighbours(unsigned int v, std::vector<unsigned int>& result) const
+{
+	result.clear();
+	for (unsigned int i = 0; i < triangles[v].size(); ++i) {
+		const unsigned int t = triangles[v][i];
+		if (!alive[t]) {
+			continue;
+		}
+		for (unsigned int k = 0; k < 3; ++k) {
+			if (indices[t * 3 + k] != v) {
+				result.push_back(indices[t * 3 + k]);
+			}
+		}
+	}
+	std::sort(result.begin(), result.end());
+	result.erase(std::unique(result.begin(), result.end()), result.end());
+}
+
+// ------------------------------------------------------------------------------------------------
+bool Simplifier :: IsValid(unsigned int from, unsigned int to) const
+{
+	// the vertices both are connected to must be those of the triangles on the edge,
+	// anything else would pinch the surface into a non-manifold
+	Neighbours(from, fromNeighbours);
+	Neighbours(to, toNeighbours);
+	common.clear();
+	std::set_intersection(fromNeighbours.begin(), fromNeighbours.end(), toNeighbours.begin(), toNeighbours.end(),
+		std::back_inserter(common));
+
+	unsigned int shared = 0;
+	for (unsigned int i = 0; i < triangles[from].size(); ++i) {
+		const unsigned int t = triangles[from][i];
+		if (alive[t] && Contains(t, to)) {
+			++shared;
+		}
+	}
+	if (!shared || common.size() > shared) {
+		return false;
+	}
+
+	// and no remaining triangle may flip over, or be turned on its edge
+	for (unsigned int i = 0; i < triangles[from].size(); ++i) {
+		const unsigned int t = triangles[from][i];
+		if (!alive[t] || Contains(t, to)) {
+			continue;
+		}
+		aiVector3D before[3], after[3];
+		for (unsigned int k = 0; k < 3; ++k) {
+			const unsigned int v = indices[t * 3 + k];
+			before[k] = mesh.mVertices[v];
+			after[k] = mesh.mVertices[v == from ? to : v];
+		}
+		const aiVector3D n0 = TriangleNormal(before[0], before[1], before[2]);
+		const aiVector3D n1 = TriangleNormal(after[0], after[1], after[2]);
+		// tilting a triangle by more than ~75 degrees in one go folds the surface over
+		if (n0 * n1 <= 0.25f * n0.Length() * n1.Length()) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// ------------------------------------------------------------------------------------------------
+void Simplifier :: Apply(unsigned int from, unsigned int to)
+{
+	for (unsigned int i = 0; i < triangles[from].size(); ++i) {
+		const unsigned int t = triangles[from][i];
+		if (!alive[t]) {
+			continue;
+		}
+		if (Contains(t, to)) {
+			alive[t] = false;
+			--aliveCount;
+			continue;
+		}
+		for (unsigned int k = 0; k < 3; ++k) {
+			if (indices[t * 3 + k] == from) {
+				indices[t * 3 + k] = to;
+			}
+		}
+		triangles[to].push_back(t);
+	}
+	triangles[from].clear();
+	removed[from] = true;
+	quadrics[to] += quadrics[from];
+
+	// drop dead triangles, or vertices surviving many collapses would keep a long tail of them
+	std::vector<unsigned int>& list = triangles[to];
+	list.erase(std::remove_if(list.begin(), list.end(), [this](unsigned int t) { return !alive[t]; }), list.end());
+}
+
+// ------------------------------------------------------------------------------------------------
+// Returns false if no collapse was possible
+bool Simplifier :: Pass(unsigned int target, double limit)
+{
+	candidates.clear();
+	for (unsigned int v = 0; v < mesh.mNumVertices; ++v) {
+		if (removed[v] || locked[v]) {
+			continue;
+		}
+		Neighbours(v, toNeighbours);
+		Collapse best;
+		best.cost = std::numeric_limits<double>::max();
+		best.from = v;
+		best.to = v;
+		for (unsigned int i = 0; i < toNeighbours.size(); ++i) {
+			const double cost = std::max(0.0, quadrics[v].Error(mesh.mVertices[toNeighbours[i]]));
+			if (cost < best.cost) {
+				best.cost = cost;
+				best.to = toNeighbours[i];
+			}
+		}
+		if (best.to != v && best.cost <= limit) {
+			candidates.push_back(best);
+		}
+	}
+	std::sort(candidates.begin(), candidates.end());
+
+	// a collapse changes the quadric of to and the triangles around from, which
+	// makes the costs computed for the vertices there stale until the next pass
+	touched.assign(mesh.mNumVertices, false);
+	unsigned int collapsed = 0;
+	for (unsigned int i = 0; i < candidates.size() && aliveCount > target; ++i) {
+		const Collapse& c = candidates[i];
+		if (touched[c.from] || touched[c.to] || !IsValid(c.from, c.to)) {
+			continue;
+		}
+		touched[c.to] = true;
+		for (unsigned int n = 0; n < fromNeighbours.size(); ++n) {
+			touched[fromNeighbours[n]] = true;
+		}
+		Apply(c.from, c.to);
+		++collapsed;
+	}
+	return collapsed > 0;
+}
+
+// ------------------------------------------------------------------------------------------------
+std::vector<unsigned int> Simplifier :: Snapshot() const
+{
+	std::vector<unsigned int> result;
+	result.reserve(aliveCount * 3);
+	for (unsigned int t = 0; t < alive.size(); ++t) {
+		if (alive[t]) {
+			result.insert(result.end(), &indices[t * 3], &indices[t * 3] + 3);
+		}
+	}
+	return result;
+}
+
+// ------------------------------------------------------------------------------------------------
+std::vector<std::vector<unsigned int> > Simplifier :: Run(unsigned int levels, float ratio, float maxError)
+{
+	std::vector<std::vector<unsigned int> > result;
+
+	// the error limit is relative to the size of the mesh
+	double limit = std::numeric_limits<double>::max();
+	if (maxError > 0 && mesh.mNumVertices) {
+		aiVector3D lo = mesh.mVertices[0], hi = mesh.mVertices[0];
+		for (unsigned int v = 1; v < mesh.mNumVertices; ++v) {
+			const aiVector3D& p = mesh.mVertices[v];
+			lo.x = std::min(lo.x, p.x); lo.y = std::min(lo.y, p.y); lo.z = std::min(lo.z, p.z);
+			hi.x = std::max(hi.x, p.x); hi.y = std::max(hi.y, p.y); hi.z = std::max(hi.z, p.z);
+		}
+		const double distance = maxError * (hi - lo).Length();
+		limit = distance * distance;
+	}
+
+	// budgets follow the triangles a level really kept, as collapses can overshoot them
+	double budget = aliveCount;
+	unsigned int lastCount = aliveCount;
+	while (result.size() < levels) {
+		budget = std::min(budget, static_cast<double>(aliveCount)) * ratio;
+		const unsigned int target = static_cast<unsigned int>(budget);
+		const unsigned int before = aliveCount;
+
+		bool exhausted = false;
+		while (aliveCount > target && !exhausted) {
+			exhausted = !Pass(target, limit);
+		}
+
+		// a level that isn't any coarser than the last is of no use
+		if (aliveCount < lastCount && aliveCount) {
+			result.push_back(Snapshot());
+			lastCount = aliveCount;
+		}
+		// a round without progress, as with a ratio of 1 or more, would be repeated forever
+		if (exhausted || aliveCount >= before) {
+			break;
+		}
+	}
+	return result;
+}
+
+// ------------------------------------------------------------------------------------------------
+// Copies the vertices used by indices into a new mesh, along with their bone weights
+aiMesh* BuildLevel(const aiMesh& source, const std::vector<unsigned int>& indices, unsigned int level)
+{
+	const unsigned int unused = std::numeric_limits<unsigned int>::max();
+	std::vector<unsigned int> remap(source.mNumVertices, unused);
+	unsigned int numVertices = 0;
+	for (unsigned int i = 0; i < indices.size(); ++i) {
+		if (remap[indices[i]] == unused) {
+			remap[indices[i]] = numVertices++;
+		}
+	}
+
+	aiMesh* const mesh = new aiMesh();
+	mesh->mName = aiString(std::string(source.mName.C_Str()) + "_lod" + std::to_string(level));
+	mesh->mMaterialIndex = source.mMaterialIndex;
+	mesh->mPrimitiveTypes = aiPrimitiveType_TRIANGLE;
+	mesh->mNumVertices = numVertices;
+
+	mesh->mVertices = new aiVector3D[numVertices];
+	if (source.HasNormals()) {
+		mesh->mNormals = new aiVector3D[numVertices];
+	}
+	if (source.HasTangentsAndBitangents()) {
+		mesh->mTangents = new aiVector3D[numVertices];
+		mesh->mBitangents = new aiVector3D[numVertices];
+	}
+	for (unsigned int c = 0; source.HasVertexColors(c); ++c) {
+		mesh->mColors[c] = new aiColor4D[numVertices];
+	}
+	for (unsigned int c = 0; source.HasTextureCoords(c); ++c) {
+		mesh->mNumUVComponents[c] = source.mNumUVComponents[c];
+		mesh->mTextureCoords[c] = new aiVector3D[numVertices];
+	}
+
+	for (unsigned int v = 0; v < source.mNumVertices; ++v) {
+		const unsigned int to = remap[v];
+		if (to == unused) {
+			continue;
+		}
+		mesh->mVertices[to] = source.mVertices[v];
+		if (mesh->mNormals) {
+			mesh->mNormals[to] = source.mNormals[v];
+		}
+		if (mesh->mTangents) {
+			mesh->mTangents[to] = source.mTangents[v];
+			mesh->mBitangents[to] = source.mBitangents[v];
+		}
+		for (unsigned int c = 0; mesh->HasVertexColors(c); ++c) {
+			mesh->mColors[c][to] = source.mColors[c][v];
+		}
+		for (unsigned int c = 0; mesh->HasTextureCoords(c); ++c) {
+			mesh->mTextureCoords[c][to] = source.mTextureCoords[c][v];
+		}
+	}
+
+	mesh->mNumFaces = static_cast<unsigned int>(indices.size() / 3);
+	mesh->mFaces = new aiFace[mesh->mNumFaces];
+	for (unsigned int f = 0; f < mesh->mNumFaces; ++f) {
+		aiFace& face = mesh->mFaces[f];
+		face.mNumIndices = 3;
+		face.mIndices = new unsigned int[3];
+		for (unsigned int k = 0; k < 3; ++k) {
+			face.mIndices[k] = remap[indices[f * 3 + k]];
+		}
+	}
+
+	// bones left without weights are dropped, which keeps bone palettes small
+	if (source.HasBones()) {
+		mesh->mBones = new aiBone*[source.mNumBones]();
+		for (unsigned int b = 0; b < source.mNumBones; ++b) {
+			const aiBone& boneIn = *source.mBones[b];
+			std::vector<aiVertexWeight> weights;
+			for (unsigned int w = 0; w < boneIn.mNumWeights; ++w) {
+				const unsigned int to = remap[boneIn.mWeights[w].mVertexId];
+				if (to != unused) {
+					weights.push_back(aiVertexWeight(to, boneIn.mWeights[w].mWeight));
+				}
+			}
+			if (weights.empty()) {
+				continue;
+			}
+			aiBone* const boneOut = new aiBone();
+			boneOut->mName = boneIn.mName;
+			boneOut->mOffsetMatrix = boneIn.mOffsetMatrix;
+			boneOut->mNumWeights = static_cast<unsigned int>(weights.size());
+			boneOut->mWeights = new aiVertexWeight[boneOut->mNumWeights];
+			std::copy(weights.begin(), weights.end(), boneOut->mWeights);
+			mesh->mBones[mesh->mNumBones++] = boneOut;
+		}
+	}
+	return mesh;
+}
+
+// ------------------------------------------------------------------------------------------------
+// Only plain triangle meshes are simplified, morph targets would need every level of their own
+bool IsSimplifiable(const aiMesh& mesh)
+{
+	if (!mesh.mNumFaces || !mesh.HasPositions() || mesh.mNumAnimMeshes) {
+		return false;
+	}
+	for (unsigned int i = 0; i < mesh.mNumFaces; ++i) {
+		if (mesh.mFaces[i].mNumIndices != 3) {
+			return false;
+		}
+	}
+	return true;
+}
+
+} // namespace
+
+// ------------------------------------------------------------------------------------------------
+void LodGenerator :: Execute(aiScene* pScene)
+{
+	levels.clear();
+	levels.resize(pScene->mNumMeshes);
+	if (!LEVELS || !pScene->mNumMeshes) {
+		return;
+	}
+
+	// meshes are independent, so simplify as many at once as there are cores
+	const unsigned int numMeshes = pScene->mNumMeshes;
+	std::vector<std::vector<aiMesh*> > generated(numMeshes);
+	std::atomic<unsigned int> next(0);
+	const std::function<void()> work = [&]() {
+		for (unsigned int m = next++; m < numMeshes; m = next++) {
+			const aiMesh& mesh = *pScene->mMeshes[m];
+			if (!IsSimplifiable(mesh)) {
+				continue;
+			}
+			const std::vector<std::vector<unsigned int> > lods = Simplifier(mesh).Run(LEVELS, RATIO, MAX_ERROR);
+			for (unsigned int l = 0; l < lods.size(); ++l) {
+				generated[m].push_back(BuildLevel(mesh, lods[l], l + 1));
+			}
+		}
+	};
+	const unsigned int hardware = std::max(1u, std::thread::hardware_concurrency());
+	std::vector<std::thread> workers;
+	for (unsigned int i = 1; i < std::min(hardware, numMeshes); ++i) {
+		workers.push_back(std::thread(work));
+	}
+	work();
+	for (unsigned int i = 0; i < workers.size(); ++i) {
+		workers[i].join();
+	}
+
+	// append the levels behind the original meshes, in mesh order
+	std::vector<aiMesh*> meshes(pScene->mMeshes, pScene->mMeshes + numMeshes);
+	for (unsigned int m = 0; m < numMeshes; ++m) {
+		std::ostringstream report;
+		report << "g3dj: levels of detail of " << pScene->mMeshes[m]->mName.C_Str() << ": " << pScene->mMeshes[m]->mNumFaces;
+		for (unsigned int l = 0; l < generated[m].size(); ++l) {
+			levels[m].push_back(static_cast<unsigned int>(meshes.size()));
+			meshes.push_back(generated[m][l]);
+			report << " -> " << generated[m][l]->mNumFaces;
+		}
+		report << " triangles";
+		if (!generated[m].empty()) {
+			Assimp::DefaultLogger::get()->info(report.str());
+		}
+	}
+
+	delete[] pScene->mMeshes;
+	pScene->mNumMeshes = static_cast<unsigned int>(meshes.size());
+	pScene->mMeshes = new aiMesh*[meshes.size()];
+	std::copy(meshes.begin(), meshes.end(), pScene->mMeshes);
+}
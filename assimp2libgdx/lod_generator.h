@@ -0,0 +1,101 @@
+/*
+Assimp2Libgdx
+Copyright (c) 2017, Eugene Wang
+
+Licensed under a 3-clause BSD license. See the LICENSE file for more information.
+*/
+
+#ifndef INCLUDED_LOD_GENERATOR
+#define INCLUDED_LOD_GENERATOR
+
+#include <vector>
+
+struct aiScene;
+struct aiMesh;
+
+// ---------------------------------------------------------------------------
+/** Generates reduced level of detail versions of the triangle meshes of a
+ *  scene, by quadric error edge collapse.
+ *
+ *  Every level keeps a fraction of the triangles of the previous one,
+ *  unless the next collapse would move the surface further than the error
+ *  limit. Collapses only ever merge a vertex into one of its neighbours, so
+ *  levels reuse the original vertices and all their components (normals,
+ *  texture coordinates, bone weights) stay valid. Vertices on borders and
+ *  on attribute seams are kept in place, so levels don't tear apart.
+ *
+ *  The levels are appended to the scene's meshes, named <mesh>_lod<n>, but
+ *  are not referenced from any node; GetLevels() tells which meshes are
+ *  levels of which. Meshes are simplified in parallel.
+ */
+class LodGenerator
+{
+
+public:
+
+	LodGenerator() : LEVELS(0), RATIO(0.5f), MAX_ERROR(0.0f) {
+	}
+
+public:
+
+	// -------------------------------------------------------------------
+	/** Sets the number of levels generated per mesh, besides the mesh
+	 * itself. 0 disables the step. */
+	void SetLevels(unsigned int l) {
+		LEVELS = l;
+	}
+
+	unsigned int GetLevels() const {
+		return LEVELS;
+	}
+
+	// -------------------------------------------------------------------
+	/** Sets the fraction of the triangles of the previous level that each
+	 * level keeps. With 1 or more, no levels are generated. */
+	void SetRatio(float r) {
+		RATIO = r;
+	}
+
+	float GetRatio() const {
+		return RATIO;
+	}
+
+	// -------------------------------------------------------------------
+	/** Sets how far collapses may move the surface, relative to the size
+	 * of the mesh's bounding box. Levels stop short of their triangle
+	 * budget rather than exceed it, and levels that would not drop any
+	 * triangles are not generated. 0 means no limit. */
+	void SetMaxError(float e) {
+		MAX_ERROR = e;
+	}
+
+	float GetMaxError() const {
+		return MAX_ERROR;
+	}
+
+public:
+
+	// -------------------------------------------------------------------
+	/** Executes the step on the given scene.
+	 * @param pScene The scene to work at.
+	 */
+	void Execute(aiScene* pScene);
+
+	// -------------------------------------------------------------------
+	/** Indices of the meshes generated as levels of the mesh at index,
+	 * coarsest last. Only valid after Execute(). */
+	const std::vector<unsigned int>& GetLevels(unsigned int index) const {
+		static const std::vector<unsigned int> none;
+		return index < levels.size() ? levels[index] : none;
+	}
+
+private:
+
+	unsigned int LEVELS;
+	float RATIO;
+	float MAX_ERROR;
+
+	std::vector<std::vector<unsigned int> > levels;
+};
+
+#endif // INCLUDED_LOD_GENERATOR
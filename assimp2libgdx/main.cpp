@@ -8,22 +8,57 @@ Licensed under a 3-clause BSD license. See the LICENSE file for more information
 
 #include <assimp/Importer.hpp>
 #include <assimp/Exporter.hpp>
+#include <assimp/DefaultLogger.hpp>
 
 #include <assimp/version.h>
 #include <assimp/postprocess.h>
 #include <assimp/scene.h>
 
 #include <iostream>
+#include <fstream>
+#include <iomanip>
 #include <cassert>
+#include <cstring>
+#include <cstdlib>
+#include <new>
+#include <memory>
+#include <sstream>
+#include <cstdio>
+#include <vector>
+
+#ifdef _WIN32
+#	include <io.h>
+#	include <fcntl.h>
+#else
+#	include <unistd.h>
+#endif
 
 #include "version.h"
+#include "assimp2libgdx.h"
+#include "import_profile.h"
+#include "conversion_stats.h"
+#include "conversion_cache.h"
+#include "mapped_io.h"
+#include "conversion_server.h"
+
+// count every allocation, assimp's included, for --stats
+void* operator new(std::size_t size)
+{
+	CountAllocation();
+	if (void* const p = std::malloc(size ? size : 1)) {
+		return p;
+	}
+	throw std::bad_alloc();
+}
 
-// json_exporter.cpp
-extern Assimp::Exporter::ExportFormatEntry Assimp2Libgdx_desc;
+void operator delete(void* p) noexcept
+{
+	std::free(p);
+}
 
 int unrecog_exit(int ex = -1)
 {
-	std::cout << "usage: assimp2libgdx [--log --verbose] input [output]" << std::endl;
+	std::cout << "usage: assimp2libgdx [flags] input [output]   (--help for details)" << std::endl;
 	return ex;
 }
 
@@ -42,66 +77,585 @@ void printver()
 
 void printhelp()
 {
+	std::cout << "usage: assimp2libgdx [flags] input [output]\n"
+		<< "(omit output to get the json string on stdout, use - as input to read stdin)\n\n"
+		<< "flags:\n"
+		<< "  --help          print this help\n"
+		<< "  --version       print version information\n"
+		<< "  --log           print import/export diagnostics to stderr\n"
+		<< "  --verbose       like --log, but include debug messages\n"
+		<< "  --maxbones=n    split skinned meshes so no part references more than n bones\n"
+		<< "                  (0, the default, disables the bone limit)\n"
+		<< "  --index-bits=n  width of the runtime's index buffers: 15 (signed 16 bit, the default),\n"
+		<< "                  16 or 32; meshes are split to fit, except with 32\n"
+		<< "  --weld=x        join vertices closer than x, relative to the mesh size, whose normals\n"
+		<< "                  and texture coordinates match within --weld-angle (degrees, default 1)\n"
+		<< "                  and --weld-uv (default 1e-5)\n"
+		<< "  --strips        write triangles as strips, for parts where that takes fewer indices\n"
+		<< "  --flatten       bake the transforms of static nodes into their meshes and merge\n"
+		<< "                  meshes sharing a material, to save nodes and draw calls\n"
+		<< "  --atlas=n       pack embedded diffuse textures of otherwise identical materials\n"
+		<< "                  into atlases of at most n x n texels, to save draw calls\n"
+		<< "  --lod=n         generate n reduced levels of detail for every triangle mesh\n"
+		<< "  --lod-ratio=x   fraction of triangles each level keeps of the last (default 0.5)\n"
+		<< "  --lod-error=x   largest surface error of a level, relative to the mesh size\n"
+		<< "  --indent=0      don't indent the json, which makes large outputs considerably smaller\n"
+		<< "  --special-floats=0  write infinite and NaN floats as 0.0 instead of as strings\n"
+		<< "  --stream        export the imported scene in place, writing meshes last and freeing\n"
+		<< "                  each one once written, for models close to the size of memory\n"
+		<< "                  (needs an output file)\n"
+		<< "  --profile=p     post processing profile: fast, balanced or max (default)\n"
+		<< "  --pp=steps      add/remove post processing steps, e.g. --pp=+FlipUVs,-FindInstances\n"
+		<< "  --smoothing=deg maximum angle for smoothing normals and tangents (default 70)\n"
+		<< "  --pptime        run post processing steps one by one and print their timings\n"
+		<< "  --config=file   read flags from file, one per line as name = value (# comments)\n"
+		<< "  --stats=json    write time, memory and output size of each conversion stage\n"
+		<< "                  to <output>.stats.json (<input>.stats.json when writing to stdout),\n"
+		<< "                  not allowed with --serve, and --connect converts locally with it\n"
+		<< "  --format=ext    file format of the input, needed when reading from stdin (-)\n"
+		<< "  --io=mode       read inputs through memory mappings (mmap, default) or stdio\n"
+		<< "  --cache=dir     reuse earlier conversions of unchanged inputs with the same flags,\n"
+		<< "                  keeping them in dir (only when writing to an output file)\n"
+		<< "  --serve=socket  keep running and serve conversion requests on a unix socket\n"
+		<< "  --workers=n     number of conversions the server runs at once (default: one per core)\n"
+		<< "  --connect=socket  have the server on socket do the conversion, converting\n"
+		<< "                  locally if there is none\n"
+		<< "\npost processing steps:\n ";
+	const std::vector<PostProcessStep>& steps = GetPostProcessSteps();
+	for (unsigned int i = 0; i < steps.size(); ++i) {
+		unsigned int first = 0;
+		while (steps[first].flag != steps[i].flag) {
+			++first;
+		}
+		if (first == i) {
+			std::cout << " " << steps[i].name;
+		}
+	}
+	std::cout << std::endl;
 }
 
-int main (int argc, char *argv[])
+// everything that can be set by flags, on the command line or in a config file
+struct Settings
 {
-	if (argc == 1) {
-		return unrecog_exit(-1);
+	Settings() : log(false), verbose(false), timeSteps(false), mapInput(true), stream(false), profile("max") {
 	}
 
-	int nextarg = 1;
-	while(nextarg < argc && argv[nextarg][0] == '-') {
-		if (!strcmp(argv[nextarg],"--help")) {
-			printhelp();
-			return 0;
+	Assimp2LibgdxOptions options;
+	bool log, verbose, timeSteps, mapInput, stream;
+	std::string profile;
+	std::string stepOverrides;
+	std::string statsFormat;
+	std::string cacheDirectory;
+	std::string format;
+	std::string serveSocket;
+	std::string connectSocket;
+
+	// all flags that affect the output, which is what cached conversions are keyed by
+	std::string signature;
+};
+
+// flags that only change what is reported, but not the output
+bool isdiagnosticflag(const std::string& name)
+{
+	static const char* const names[] = { "--log", "--verbose", "--pptime", "--stats", "--cache", "--io", "--serve", "--workers", "--connect" };
+	for (unsigned int i = 0; i < sizeof(names) / sizeof(names[0]); ++i) {
+		if (name == names[i]) {
+			return true;
 		}
-		else if (!strcmp(argv[nextarg],"--version")) {
-			printver();
-			return 0;
+	}
+	return false;
+}
+
+enum ParseResult
+{
+	Parse_Continue,
+	Parse_Exit,
+	Parse_Error
+};
+
+ParseResult parseconfig(const std::string& path, Settings& settings, std::ostream& err);
+
+// parses one flag of the form --name or --name=value
+ParseResult parseflag(const std::string& arg, Settings& settings, std::ostream& err = std::cerr)
+{
+	const std::string::size_type eq = arg.find('=');
+	const std::string name = arg.substr(0, eq);
+	const std::string value = eq == std::string::npos ? std::string() : arg.substr(eq + 1);
+
+	if (name == "--help") {
+		printhelp();
+		return Parse_Exit;
+	}
+	else if (name == "--version") {
+		printver();
+		return Parse_Exit;
+	}
+	else if (name == "--log") {
+		settings.log = true;
+	}
+	else if (name == "--verbose") {
+		settings.log = settings.verbose = true;
+	}
+	else if (name.compare(0, 2, "--") == 0 && Assimp2LibgdxOptions::IsFlag(name.substr(2))) {
+		// options in the table of export_options.cpp, which parses and checks them
+		std::string error;
+		if (!settings.options.SetFlag(name.substr(2), value, error)) {
+			err << error << std::endl;
+			return Parse_Error;
 		}
-		++nextarg;
+	}
+	else if (name == "--stream") {
+		settings.stream = true;
+	}
+	else if (name == "--profile") {
+		unsigned int flags;
+		if (!GetProfileFlags(value, flags)) {
+			err << "unknown profile: " << value << std::endl;
+			return Parse_Error;
+		}
+		settings.profile = value;
+	}
+	else if (name == "--pp") {
+		settings.stepOverrides += "," + value;
+	}
+	else if (name == "--pptime") {
+		settings.timeSteps = true;
+	}
+	else if (name == "--stats") {
+		if (value != "json") {
+			err << "unknown stats format: " << value << std::endl;
+			return Parse_Error;
+		}
+		settings.statsFormat = value;
+	}
+	else if (name == "--io") {
+		if (value != "mmap" && value != "stdio") {
+			err << "unknown io mode: " << value << std::endl;
+			return Parse_Error;
+		}
+		settings.mapInput = value == "mmap";
+	}
+	else if (name == "--format") {
+		settings.format = value;
+	}
+	else if (name == "--cache") {
+		settings.cacheDirectory = value;
+	}
+	else if (name == "--serve") {
+		settings.serveSocket = value;
+	}
+	else if (name == "--connect") {
+		settings.connectSocket = value;
+	}
+	else if (name == "--config") {
+		return parseconfig(value, settings, err);
+	}
+	else {
+		err << "unrecognized flag: " << arg << std::endl;
+		return Parse_Error;
 	}
 
-	if (argc < nextarg+1) {
-		return unrecog_exit(-2);
+	if (!isdiagnosticflag(name)) {
+		settings.signature += arg + "\n";
+	}
+	return Parse_Continue;
+}
+
+// config files hold one flag per line, written as "name = value" or "name"
+ParseResult parseconfig(const std::string& path, Settings& settings, std::ostream& err)
+{
+	std::ifstream file(path.c_str());
+	if (!file) {
+		err << "failure reading config file: " << path << std::endl;
+		return Parse_Error;
+	}
+
+	std::string line;
+	while (std::getline(file, line)) {
+		const std::string::size_type comment = line.find('#');
+		if (comment != std::string::npos) {
+			line.erase(comment);
+		}
+
+		// strip all whitespace, none of the values need it
+		std::string flag;
+		for (unsigned int i = 0; i < line.size(); ++i) {
+			if (!isspace(static_cast<unsigned char>(line[i]))) {
+				flag.push_back(line[i]);
+			}
+		}
+		if (flag.empty()) {
+			continue;
+		}
+
+		const ParseResult result = parseflag("--" + flag, settings, err);
+		if (result != Parse_Continue) {
+			return result;
+		}
+	}
+	return Parse_Continue;
+}
+
+// writes the --stats report next to the output
+bool writestats(const Settings& settings, const ConversionStats& stats, const char* in, const char* out, std::ostream& err)
+{
+	if (settings.statsFormat.empty()) {
+		return true;
+	}
+	const std::string statsFile = std::string(out ? out : strcmp(in, "-") ? in : "stdin") + ".stats.json";
+	std::ofstream report(statsFile.c_str());
+	stats.WriteJson(report, in);
+	if (!report) {
+		err << "failure writing stats: " << statsFile << std::endl;
+		return false;
+	}
+	return true;
+}
+
+// reads all of stdin, for inputs coming through a pipe
+bool readstdin(std::vector<char>& data)
+{
+#ifdef _WIN32
+	_setmode(_fileno(stdin), _O_BINARY);
+#endif
+	char buffer[1 << 16];
+	size_t read;
+	while ((read = fread(buffer, 1, sizeof(buffer), stdin)) > 0) {
+		data.insert(data.end(), buffer, buffer + read);
+	}
+	return !ferror(stdin) && !data.empty();
+}
+
+// identifies the converter, so cached conversions of other versions are not reused
+std::string versionsignature()
+{
+	std::ostringstream s;
+	s << "assimp2libgdx " << ASSIMP2LIBGDX_VERSION_MAJOR << "." << ASSIMP2LIBGDX_VERSION_MINOR << "." << ASSIMP2LIBGDX_VERSION_PATCH
+		<< ", assimp " << aiGetVersionMajor() << "." << aiGetVersionMinor() << "." << aiGetVersionRevision() << "\n";
+	return s.str();
+}
+
+// post processing steps of the profile in settings, with the --pp overrides applied
+bool getppflags(const Settings& settings, unsigned int& ppflags, std::ostream& err)
+{
+	GetProfileFlags(settings.profile, ppflags);
+	std::string error;
+	if (!ApplyStepOverrides(settings.stepOverrides, ppflags, error)) {
+		err << error << std::endl;
+		return false;
+	}
+	return true;
+}
+
+// importer and exporter of a conversion, the server keeps one per worker between requests
+struct Converter
+{
+	Converter() {
+		aiReturn checkReturn = exp.RegisterExporter(Assimp2Libgdx_desc);
+		assert(checkReturn == aiReturn_SUCCESS);
+		(void)checkReturn;
 	}
 
-	const char* in = argv[nextarg], *out = (argc < nextarg+2 ? NULL : argv[nextarg+1]);
-	
 	Assimp::Importer imp;
+	Assimp::Exporter exp;
+};
+
+// stats are installed per thread, and must not outlive the conversion they belong to
+struct StatsInstaller
+{
+	explicit StatsInstaller(ConversionStats* stats) {
+		ConversionStats::SetCurrent(stats);
+	}
+	~StatsInstaller() {
+		ConversionStats::SetCurrent(nullptr);
+	}
+};
+
+// converts in to out (stdout if out is NULL), returning the exit code
+int convert(const Settings& settings, unsigned int ppflags, const char* in, const char* out, Converter& converter, std::ostream& err)
+{
+	// the exporter registered with assimp gets its options as properties
+	Assimp::ExportProperties props;
+	settings.options.Store(props);
+	const bool fromStdin = !strcmp(in, "-");
+
+	ConversionStats stats;
+	StatsInstaller installer(settings.statsFormat.empty() ? nullptr : &stats);
 
-	// instruct aiProcess_GenSmoothNormals to not smooth normals with an angle of more than 70deg
-	imp.SetPropertyFloat(AI_CONFIG_PP_GSN_MAX_SMOOTHING_ANGLE, 70.0f);
-	// instruct aiProcess_CalcTangents to not smooth normals with an angle of more than 70deg
-	imp.SetPropertyFloat(AI_CONFIG_PP_CT_MAX_SMOOTHING_ANGLE, 70.0f);
+	// with a cache, unchanged inputs skip import and export altogether
+	std::unique_ptr<ConversionCache> cache;
+	if (!settings.cacheDirectory.empty() && out && !fromStdin) {
+		cache.reset(new ConversionCache(settings.cacheDirectory, versionsignature() + settings.signature));
 
-	const aiScene* const sc = imp.ReadFile(in,aiProcessPreset_TargetRealtime_MaxQuality);
+		bool hit;
+		{
+			ConversionStats::Scope stage("cache lookup");
+			hit = cache->Fetch(in, out);
+		}
+		if (hit) {
+			return writestats(settings, stats, in, out, err) ? 0 : -6;
+		}
+
+		// the old output might be linked into the cache, don't write through it
+		std::remove(out);
+	}
+
+	Assimp::Importer& imp = converter.imp;
+	Assimp::Exporter& exp = converter.exp;
+
+	// importer and exporter take ownership of these
+	RecordingIOSystem* importIO = nullptr;
+	RecordingIOSystem* exportIO = nullptr;
+	if (cache) {
+		importIO = new RecordingIOSystem(settings.mapInput);
+		imp.SetIOHandler(importIO);
+		exportIO = new RecordingIOSystem();
+		exp.SetIOHandler(exportIO);
+	}
+	else {
+		imp.SetIOHandler(new MappedIOSystem(settings.mapInput));
+		exp.SetIOHandler(new Assimp::DefaultIOSystem());
+	}
+
+	// instruct aiProcess_GenSmoothNormals to not smooth normals with an angle of more than 70deg (by default)
+	imp.SetPropertyFloat(AI_CONFIG_PP_GSN_MAX_SMOOTHING_ANGLE, settings.options.smoothingAngle);
+	// instruct aiProcess_CalcTangents to not smooth normals with an angle of more than 70deg (by default)
+	imp.SetPropertyFloat(AI_CONFIG_PP_CT_MAX_SMOOTHING_ANGLE, settings.options.smoothingAngle);
+
+	// the whole input has to be in memory for ReadFileFromMemory(), assimp can't stream
+	std::vector<char> input;
+	if (fromStdin) {
+		ConversionStats::Scope stage("read stdin");
+		if (!readstdin(input)) {
+			err << "failure reading from (stdin)" << std::endl;
+			return -3;
+		}
+	}
+
+	const aiScene* sc;
+	{
+		ConversionStats::Scope stage("import");
+		if (settings.timeSteps) {
+			std::vector<std::pair<std::string, double> > timings;
+			sc = fromStdin ? ReadFileFromMemoryTimed(imp, input.data(), input.size(), settings.format.c_str(), ppflags, timings)
+				: ReadFileTimed(imp, in, ppflags, timings);
+
+			err << "post processing timings:\n";
+			for (unsigned int i = 0; i < timings.size(); ++i) {
+				err << "  " << std::left << std::setw(26) << timings[i].first 
+					<< std::right << std::fixed << std::setprecision(3) << timings[i].second << " s\n";
+			}
+			err << std::flush;
+		}
+		else if (fromStdin) {
+			sc = imp.ReadFileFromMemory(input.data(),input.size(),ppflags,settings.format.c_str());
+		}
+		else {
+			sc = imp.ReadFile(in,ppflags);
+		}
+	}
 	if (!sc) {
-		std::cerr << "failure reading file: " << in << std::endl;
+		err << "failure reading file: " << (fromStdin ? "(stdin)" : in) << ": " << imp.GetErrorString() << std::endl;
 		return -3;
 	}
+	// the scene holds everything we need, don't keep a second copy of the input around
+	std::vector<char>().swap(input);
 
-	Assimp::Exporter exp;
-	aiReturn checkReturn = exp.RegisterExporter(Assimp2Libgdx_desc);
-	assert(checkReturn == aiReturn_SUCCESS);
-
-	if(out) {
-		if(aiReturn_SUCCESS != exp.Export(sc,"g3dj",out)) {
-			std::cerr << "failure exporting file: " << out << ": " << exp.GetErrorString() << std::endl;
+	if (settings.stream) {
+		// the exporter would copy the scene, skip it and hand over the imported one
+		ConversionStats::Scope stage("export");
+		try {
+			Assimp2LibgdxExportInPlace(imp.GetOrphanedScene(), out, exportIO, settings.options);
+		}
+		catch (const std::exception& exc) {
+			err << "failure exporting file: " << out << ": " << exc.what() << std::endl;
 			return -4;
 		}
 	}
 	else {
-		// write to stdout, but we might do better than using ExportToBlob()
-		const aiExportDataBlob* const blob = exp.ExportToBlob(sc,"g3dj");
-		if(blob == nullptr) {
-			std::cerr << "failure exporting to (stdout) " << exp.GetErrorString() << std::endl;
-			return -5;
+		ConversionStats::Scope stage("export");
+		if(out) {
+			if(aiReturn_SUCCESS != exp.Export(sc,"g3dj",out,0u,&props)) {
+				err << "failure exporting file: " << out << ": " << exp.GetErrorString() << std::endl;
+				imp.FreeScene();
+				return -4;
+			}
 		}
+		else {
+			// write to stdout, but we might do better than using ExportToBlob()
+			const aiExportDataBlob* const blob = exp.ExportToBlob(sc,"g3dj",0u,&props);
+			if(blob == nullptr) {
+				err << "failure exporting to (stdout) " << exp.GetErrorString() << std::endl;
+				imp.FreeScene();
+				return -5;
+			}
+
+			const std::string s(static_cast<char*>( blob->data), blob->size);
+			std::cout << s << std::endl;
 
-		const std::string s(static_cast<char*>( blob->data), blob->size);
-		std::cout << s << std::endl;
+			// any further blobs hold the embedded textures, which have no place on stdout
+			if (blob->next) {
+				err << "warning: embedded textures are not written when exporting to (stdout), specify an output file" << std::endl;
+			}
+			exp.FreeBlob();
+		}
+	}
+	// a reused importer would otherwise hold on to the scene until the next request
+	imp.FreeScene();
+
+	if (cache) {
+		ConversionStats::Scope stage("cache store");
+		if (!cache->Store(in, out, importIO->GetReadFiles(), exportIO->GetWrittenFiles())) {
+			err << "warning: failure storing the conversion in the cache" << std::endl;
+		}
+	}
+
+	if (!writestats(settings, stats, in, out, err)) {
+		return -6;
 	}
 	return 0;
 }
+
+// handles one request of --serve, on a worker thread; flags of the request add to those of the server
+int serverequest(const Settings& defaults, const std::vector<std::string>& args, std::ostream& err)
+{
+	Settings settings = defaults;
+	unsigned int nextarg = 0;
+	while (nextarg < args.size() && args[nextarg].size() > 1 && args[nextarg][0] == '-') {
+		const std::string name = args[nextarg].substr(0, args[nextarg].find('='));
+		// stats are process wide, so they can't tell concurrent requests apart
+		if (name == "--help" || name == "--version" || name == "--serve" || name == "--workers" || name == "--connect"
+			|| name == "--stats") {
+			err << "flag not allowed in requests: " << name << std::endl;
+			return -1;
+		}
+		if (parseflag(args[nextarg], settings, err) != Parse_Continue) {
+			return -1;
+		}
+		++nextarg;
+	}
+
+	unsigned int ppflags;
+	if (!getppflags(settings, ppflags, err)) {
+		return -1;
+	}
+	if (args.size() != nextarg + 2 || args[nextarg] == "-") {
+		err << "requests need an input and an output file" << std::endl;
+		return -2;
+	}
+
+	// a warm importer and exporter for every worker, that's what the server is for
+	static thread_local Converter converter;
+	return convert(settings, ppflags, args[nextarg].c_str(), args[nextarg+1].c_str(), converter, err);
+}
+
+// the server doesn't share our working directory
+std::string absolutepath(const std::string& path)
+{
+#ifndef _WIN32
+	char cwd[4096];
+	if (!path.empty() && path[0] != '/' && getcwd(cwd, sizeof(cwd))) {
+		return std::string(cwd) + "/" + path;
+	}
+#endif
+	return path;
+}
+
+// the request for --connect: our flags and files, with paths made absolute
+std::vector<std::string> clientrequest(int argc, char* argv[], int nextarg)
+{
+	std::vector<std::string> args;
+	for (int i = 1; i < nextarg; ++i) {
+		const std::string arg = argv[i];
+		const std::string::size_type eq = arg.find('=');
+		const std::string name = arg.substr(0, eq);
+		if (name == "--connect") {
+			continue;
+		}
+		else if (name == "--config" || name == "--cache") {
+			args.push_back(name + "=" + absolutepath(arg.substr(eq + 1)));
+		}
+		else {
+			args.push_back(arg);
+		}
+	}
+	for (int i = nextarg; i < argc; ++i) {
+		args.push_back(absolutepath(argv[i]));
+	}
+	return args;
+}
+
+int main (int argc, char *argv[])
+{
+	if (argc == 1) {
+		return unrecog_exit(-1);
+	}
+
+	Settings settings;
+
+	int nextarg = 1;
+	// a lone - is not a flag, but stdin
+	while(nextarg < argc && argv[nextarg][0] == '-' && argv[nextarg][1] != '\0') {
+		const ParseResult result = parseflag(argv[nextarg], settings);
+		if (result == Parse_Exit) {
+			return 0;
+		}
+		else if (result == Parse_Error) {
+			return unrecog_exit(-1);
+		}
+		++nextarg;
+	}
+
+	unsigned int ppflags;
+	if (!getppflags(settings, ppflags, std::cerr)) {
+		return unrecog_exit(-1);
+	}
+
+	// diagnostics go to stderr, so they never end up in the json written to stdout
+	if (settings.log) {
+		Assimp::DefaultLogger::create("",settings.verbose ? Assimp::Logger::VERBOSE : Assimp::Logger::NORMAL,aiDefaultLogStream_STDERR);
+	}
+
+	if (!settings.serveSocket.empty()) {
+		if (!settings.statsFormat.empty()) {
+			std::cerr << "--stats can't be used with --serve" << std::endl;
+			return unrecog_exit(-1);
+		}
+		using namespace std::placeholders;
+		ConversionServer server(settings.serveSocket, static_cast<unsigned int>(settings.options.workers), std::bind(serverequest, std::cref(settings), _1, _2));
+		std::string error;
+		if (!server.Run(error)) {
+			std::cerr << error << std::endl;
+			return -7;
+		}
+		return 0;
+	}
+
+	if (argc < nextarg+1) {
+		return unrecog_exit(-2);
+	}
+
+	const char* in = argv[nextarg], *out = (argc < nextarg+2 ? NULL : argv[nextarg+1]);
+
+	// only conversions between files can be handed to a server, and only those without
+	// --stats, which measures this process
+	if (!settings.connectSocket.empty() && out && strcmp(in, "-") && settings.statsFormat.empty()) {
+		int status;
+		std::string messages;
+		if (SendConversionRequest(settings.connectSocket, clientrequest(argc, argv, nextarg), status, messages)) {
+			std::cerr << messages << std::flush;
+			return status;
+		}
+		if (settings.log) {
+			std::cerr << "no server on " << settings.connectSocket << ", converting locally" << std::endl;
+		}
+	}
+
+	if (settings.stream && !out) {
+		std::cerr << "--stream needs an output file" << std::endl;
+		return unrecog_exit(-2);
+	}
+
+	Converter converter;
+	return convert(settings, ppflags, in, out, converter, std::cerr);
+}
@@ -0,0 +1,121 @@
+/*
+Assimp2Libgdx
+Copyright (c) 2017, Eugene Wang
+
+Licensed under a 3-clause BSD license. See the LICENSE file for more information.
+*/
+
+#include "mapped_io.h"
+
+#include <algorithm>
+#include <cstring>
+
+#ifndef _WIN32
+#	include <fcntl.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <unistd.h>
+#endif
+
+// ------------------------------------------------------------------------------------------------
+MappedIOStream :: MappedIOStream(void* mapping, size_t size)
+	: mapping(mapping), size(size), position(0)
+{
+}
+
+// ------------------------------------------------------------------------------------------------
+MappedIOStream :: ~MappedIOStream()
+{
+#ifndef _WIN32
+	munmap(mapping, size);
+#endif
+}
+
+// ------------------------------------------------------------------------------------------------
+size_t MappedIOStream :: Read(void* pvBuffer, size_t pSize, size_t pCount)
+{
+	if (!pSize) {
+		return 0;
+	}
+	// like fread, only whole elements are read
+	const size_t count = std::min(pCount, (size - position) / pSize);
+	memcpy(pvBuffer, static_cast<const char*>(mapping) + position, count * pSize);
+	position += count * pSize;
+	return count;
+}
+
+// ------------------------------------------------------------------------------------------------
+size_t MappedIOStream :: Write(const void*, size_t, size_t)
+{
+	return 0;
+}
+
+// ------------------------------------------------------------------------------------------------
+aiReturn MappedIOStream :: Seek(size_t pOffset, aiOrigin pOrigin)
+{
+	size_t target;
+	switch (pOrigin)
+	{
+	case aiOrigin_SET:
+		target = pOffset;
+		break;
+	case aiOrigin_CUR:
+		target = position + pOffset;
+		break;
+	case aiOrigin_END:
+		// assimp passes negative offsets from the end as wrapped size_t
+		target = size + pOffset;
+		break;
+	default:
+		return aiReturn_FAILURE;
+	}
+	if (target > size) {
+		return aiReturn_FAILURE;
+	}
+	position = target;
+	return aiReturn_SUCCESS;
+}
+
+// ------------------------------------------------------------------------------------------------
+size_t MappedIOStream :: Tell() const
+{
+	return position;
+}
+
+// ------------------------------------------------------------------------------------------------
+size_t MappedIOStream :: FileSize() const
+{
+	return size;
+}
+
+// ------------------------------------------------------------------------------------------------
+void MappedIOStream :: Flush()
+{
+}
+
+// ------------------------------------------------------------------------------------------------
+Assimp::IOStream* MappedIOSystem :: Open(const char* pFile, const char* pMode)
+{
+#ifndef _WIN32
+	const bool readOnly = pMode[0] == 'r' && !strchr(pMode, '+');
+	if (map && readOnly) {
+		const int fd = open(pFile, O_RDONLY);
+		if (fd >= 0) {
+			struct stat info;
+			void* mapping = MAP_FAILED;
+			// only regular files can be mapped, pipes and devices take the default path
+			if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+				mapping = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+			}
+			close(fd);
+
+			if (mapping != MAP_FAILED) {
+				// importers mostly read front to back, let the kernel read ahead aggressively
+				madvise(mapping, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+				return new MappedIOStream(mapping, static_cast<size_t>(info.st_size));
+			}
+		}
+	}
+#endif
+	return DefaultIOSystem::Open(pFile, pMode);
+}
@@ -0,0 +1,69 @@
+/*
+Assimp2Libgdx
+Copyright (c) 2017, Eugene Wang
+
+Licensed under a 3-clause BSD license. See the LICENSE file for more information.
+*/
+
+#ifndef INCLUDED_MAPPED_IO
+#define INCLUDED_MAPPED_IO
+
+#include <assimp/DefaultIOSystem.h>
+#include <assimp/IOStream.hpp>
+
+#include <cstddef>
+
+// ---------------------------------------------------------------------------
+/** Read-only stream over a memory mapped file. */
+class MappedIOStream : public Assimp::IOStream
+{
+
+public:
+
+	MappedIOStream(void* mapping, size_t size);
+	~MappedIOStream();
+
+public:
+
+	size_t Read(void* pvBuffer, size_t pSize, size_t pCount);
+	size_t Write(const void* pvBuffer, size_t pSize, size_t pCount);
+	aiReturn Seek(size_t pOffset, aiOrigin pOrigin);
+	size_t Tell() const;
+	size_t FileSize() const;
+	void Flush();
+
+private:
+
+	void* mapping;
+	size_t size;
+	size_t position;
+};
+
+// ---------------------------------------------------------------------------
+/** IOSystem that serves reads of regular files from memory mappings, so
+ *  large inputs are paged in lazily by the kernel instead of being copied
+ *  through stdio buffers. Mappings are hinted for sequential access.
+ *
+ *  Everything that can't be mapped (pipes, empty files, writes, platforms
+ *  without mmap) falls back to assimp's DefaultIOSystem.
+ */
+class MappedIOSystem : public Assimp::DefaultIOSystem
+{
+
+public:
+
+	// -------------------------------------------------------------------
+	/** @param map false to always use DefaultIOSystem, for comparison */
+	explicit MappedIOSystem(bool map = true) : map(map) {
+	}
+
+public:
+
+	Assimp::IOStream* Open(const char* pFile, const char* pMode = "rb");
+
+private:
+
+	bool map;
+};
+
+#endif // INCLUDED_MAPPED_IO
@@ -11,6 +11,9 @@ Licensed under a 3-clause BSD license. See the LICENSE file for more information
 
 #include <assimp/scene.h>
 
+#include <algorithm>
+#include <cstring>
+
 // ----------------------------------------------------------------------------
 // Note: this is largely based on assimp's SplitLargeMeshes_Vertex process.
 // it is refactored and the coding style is slightly improved, though.
@@ -61,7 +64,7 @@ void MeshSplitter :: UpdateNode(aiNode* pcNode, const std::vector<std::pair<aiMe
 	}
 
 	// now build the new list
-	delete pcNode->mMeshes;
+	delete[] pcNode->mMeshes;
 	pcNode->mNumMeshes = static_cast<unsigned int>(aiEntries.size());
 	pcNode->mMeshes = new unsigned int[pcNode->mNumMeshes];
 
@@ -106,7 +109,8 @@ void MeshSplitter :: SplitMesh(unsigned int a, aiMesh* in_mesh,
 {
 	// TODO: should better use std::(multi)set for source_mesh_map.
 
-	if (in_mesh->mNumVertices <= LIMIT)	{
+	const bool split_by_bones = BONE_LIMIT && in_mesh->mNumBones > BONE_LIMIT;
+	if (in_mesh->mNumVertices <= LIMIT && !split_by_bones)	{
 		source_mesh_map.push_back(std::make_pair(in_mesh,a));
 		return;
 	}
@@ -115,7 +119,10 @@ void MeshSplitter :: SplitMesh(unsigned int a, aiMesh* in_mesh,
 	VertexWeightTable* avPerVertexWeights = ComputeVertexBoneWeightTable(in_mesh);
 
 	// we need to split this mesh into sub meshes. Estimate submesh size
-	const unsigned int sub_meshes = (in_mesh->mNumVertices / LIMIT) + 1;
+	unsigned int sub_meshes = (in_mesh->mNumVertices / LIMIT) + 1;
+	if (split_by_bones) {
+		sub_meshes = std::max(sub_meshes, (in_mesh->mNumBones / BONE_LIMIT) + 1);
+	}
 
 	// create a std::vector<unsigned int> to remember which vertices have already 
 	// been copied and to which position (i.e. output index)
@@ -127,10 +134,14 @@ void MeshSplitter :: SplitMesh(unsigned int a, aiMesh* in_mesh,
 	unsigned int size_estimated = in_mesh->mNumFaces / sub_meshes;
 	size_estimated += size_estimated / 8;
 
+	// bones referenced by the face currently being looked at, but not yet by the submesh
+	std::vector<unsigned int> face_bones;
+
 	// now generate all submeshes
 	unsigned int base = 0;
 	while (true) {
-		const unsigned int out_vertex_index = LIMIT;
+		const unsigned int out_vertex_index = std::min(LIMIT, in_mesh->mNumVertices);
+		unsigned int out_num_bones = 0;
 
 		aiMesh* out_mesh = new aiMesh();			
 		out_mesh->mNumVertices = 0;
@@ -181,18 +192,36 @@ void MeshSplitter :: SplitMesh(unsigned int a, aiMesh* in_mesh,
 
 			// doesn't catch degenerates but is quite fast
 			unsigned int iNeed = 0;
+			face_bones.clear();
 			for (unsigned int v = 0; v < iNumIndices;++v)	{
 				unsigned int index = in_mesh->mFaces[base].mIndices[v];
 
 				// check whether we do already have this vertex
 				if (WAS_NOT_COPIED == was_copied_to[index])	{
 					iNeed++; 
+
+					// and whether it drags in bones this submesh does not reference yet
+					if (split_by_bones) {
+						const VertexWeightTable& table = avPerVertexWeights[index];
+						for (VertexWeightTable::const_iterator iter = table.begin(), end = table.end(); iter != end;++iter) {
+							if (!out_mesh->mBones[(*iter).first] && 
+								std::find(face_bones.begin(), face_bones.end(), (*iter).first) == face_bones.end()) {
+								face_bones.push_back((*iter).first);
+							}
+						}
+					}
 				}
 			}
 			if (out_mesh->mNumVertices + iNeed > out_vertex_index)	{
 				// don't use this face
 				break;
 			}
+			// a single face referencing more bones than allowed can't be split any 
+			// further, so an empty submesh always takes at least one face
+			if (split_by_bones && !vFaces.empty() && out_num_bones + face_bones.size() > BONE_LIMIT) {
+				break;
+			}
+			out_num_bones += static_cast<unsigned int>(face_bones.size());
 
 			vFaces.push_back(aiFace());
 			aiFace& rFace = vFaces.back();
@@ -256,7 +285,7 @@ void MeshSplitter :: SplitMesh(unsigned int a, aiMesh* in_mesh,
 				// check whether we have bone weights assigned to this vertex
 				rFace.mIndices[v] = out_mesh->mNumVertices;
 				if (avPerVertexWeights) {
-					VertexWeightTable& table = avPerVertexWeights[ out_mesh->mNumVertices ];
+					VertexWeightTable& table = avPerVertexWeights[ index ];
 					for (VertexWeightTable::const_iterator iter = table.begin(), end = table.end(); iter != end;++iter) {
 						// allocate the bone weight array if necessary and store it in the mBones field (HACK!)
 						BoneWeightList* weight_list = reinterpret_cast<BoneWeightList*>(out_mesh->mBones[(*iter).first]);
@@ -278,7 +307,9 @@ void MeshSplitter :: SplitMesh(unsigned int a, aiMesh* in_mesh,
 			}
 		}
 
-		// check which bones we'll need to create for this submesh
+		// check which bones we'll need to create for this submesh. Bones are
+		// compacted in their original order, so each submesh gets its own
+		// palette containing only the bones its vertices are weighted to.
 		if (in_mesh->HasBones()) {
 			aiBone** ppCurrent = out_mesh->mBones;
 			for (unsigned int k = 0; k < in_mesh->mNumBones;++k) {
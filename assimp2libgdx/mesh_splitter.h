@@ -23,10 +23,19 @@ struct aiNode;
 // ---------------------------------------------------------------------------
 /** Splits meshes of unique vertices into meshes with no more vertices than
  *  a given, configurable threshold value. 
+ *
+ *  Optionally, skinned meshes are also split so that no output mesh
+ *  references more bones than a given bone limit, which is what a single
+ *  draw call can bind in its uniform palette when skinning on the GPU.
  */
 class MeshSplitter 
 {
 
+public:
+
+	MeshSplitter() : LIMIT(1 << 15), BONE_LIMIT(0) {
+	}
+
 public:
 	
 	void SetLimit(unsigned int l) {
@@ -37,6 +46,18 @@ public:
 		return LIMIT;
 	}
 
+	// -------------------------------------------------------------------
+	/** Sets the maximum number of bones a single output mesh may
+	 *  reference. 0 means that meshes are not split by bone count.
+	 */
+	void SetBoneLimit(unsigned int l) {
+		BONE_LIMIT = l;
+	}
+
+	unsigned int GetBoneLimit() const {
+		return BONE_LIMIT;
+	}
+
 public:
 
 	// -------------------------------------------------------------------
@@ -55,6 +76,7 @@ private:
 public:
 
 	unsigned int LIMIT;
+	unsigned int BONE_LIMIT;
 };
 
 #endif // INCLUDED_MESH_SPLITTER
@@ -0,0 +1,231 @@
+/*
+Assimp2Libgdx
+Copyright (c) 2017, Eugene Wang
+
+Licensed under a 3-clause BSD license. See the LICENSE file for more information.
+*/
+
+#include "scene_flattener.h"
+#include "scene_utils.h"
+
+#include <assimp/scene.h>
+#include <assimp/DefaultLogger.hpp>
+
+#include <algorithm>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace {
+
+// A node of the graph, listed depth first
+struct FlatNode
+{
+	FlatNode(aiNode* node, int parent) : node(node), parent(parent), kept(false), target(-1) {
+	}
+
+	aiNode* node;
+	int parent; // -1 for the root
+	bool kept;
+	int target; // for removed nodes, the node which stays that their meshes move to
+	aiMatrix4x4 transform; // for removed nodes, from their space to the space of target
+};
+
+// ------------------------------------------------------------------------------------------------
+// Names of the nodes whose transform is needed at runtime
+std::set<std::string> DynamicNodeNames(const aiScene* pScene)
+{
+	std::set<std::string> names;
+	for (unsigned int a = 0; a < pScene->mNumAnimations; ++a) {
+		const aiAnimation& anim = *pScene->mAnimations[a];
+		for (unsigned int c = 0; c < anim.mNumChannels; ++c) {
+			names.insert(anim.mChannels[c]->mNodeName.C_Str());
+		}
+	}
+	for (unsigned int i = 0; i < pScene->mNumMeshes; ++i) {
+		const aiMesh& mesh = *pScene->mMeshes[i];
+		for (unsigned int b = 0; b < mesh.mNumBones; ++b) {
+			names.insert(mesh.mBones[b]->mName.C_Str());
+		}
+	}
+	for (unsigned int i = 0; i < pScene->mNumCameras; ++i) {
+		names.insert(pScene->mCameras[i]->mName.C_Str());
+	}
+	for (unsigned int i = 0; i < pScene->mNumLights; ++i) {
+		names.insert(pScene->mLights[i]->mName.C_Str());
+	}
+	return names;
+}
+
+// ------------------------------------------------------------------------------------------------
+bool IsDynamic(const aiScene* pScene, const aiNode& node, const std::set<std::string>& names)
+{
+	if (names.count(node.mName.C_Str())) {
+		return true;
+	}
+	for (unsigned int i = 0; i < node.mNumMeshes; ++i) {
+		if (!IsMergeable(*pScene->mMeshes[node.mMeshes[i]])) {
+			return true;
+		}
+	}
+	return false;
+}
+
+// ------------------------------------------------------------------------------------------------
+// Moves the vertices of a mesh by a transform. Normals and tangents are transformed by the
+// inverse transpose, and faces are flipped if the transform mirrors.
+void BakeTransform(aiMesh& mesh, const aiMatrix4x4& transform)
+{
+	if (transform.IsIdentity()) {
+		return;
+	}
+
+	const aiMatrix3x3 rotation(transform);
+	aiMatrix3x3 normals(transform);
+	normals.Inverse().Transpose();
+
+	for (unsigned int v = 0; v < mesh.mNumVertices; ++v) {
+		mesh.mVertices[v] = transform * mesh.mVertices[v];
+	}
+	if (mesh.mNormals) {
+		for (unsigned int v = 0; v < mesh.mNumVertices; ++v) {
+			mesh.mNormals[v] = (normals * mesh.mNormals[v]).Normalize();
+		}
+	}
+	if (mesh.mTangents) {
+		for (unsigned int v = 0; v < mesh.mNumVertices; ++v) {
+			mesh.mTangents[v] = (rotation * mesh.mTangents[v]).Normalize();
+			mesh.mBitangents[v] = (rotation * mesh.mBitangents[v]).Normalize();
+		}
+	}
+
+	if (rotation.Determinant() < 0) {
+		for (unsigned int f = 0; f < mesh.mNumFaces; ++f) {
+			aiFace& face = mesh.mFaces[f];
+			std::reverse(face.mIndices, face.mIndices + face.mNumIndices);
+		}
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+void SetMeshes(aiNode* pNode, const std::vector<unsigned int>& meshes)
+{
+	delete[] pNode->mMeshes;
+	pNode->mNumMeshes = static_cast<unsigned int>(meshes.size());
+	pNode->mMeshes = meshes.empty() ? nullptr : new unsigned int[meshes.size()];
+	std::copy(meshes.begin(), meshes.end(), pNode->mMeshes);
+}
+
+} //
+
+// ------------------------------------------------------------------------------------------------
+// Executes the flattening step on the given scene.
+void SceneFlattener :: Execute( aiScene* pScene)
+{
+	nodesBefore = nodesAfter = drawCallsBefore = drawCallsAfter = 0;
+	if (!pScene->mRootNode) {
+		return;
+	}
+	nodesBefore = CountNodes(pScene->mRootNode);
+	drawCallsBefore = CountDrawCalls(pScene->mRootNode);
+
+	// hierarchies which are worth flattening tend to be deep, so they are walked without recursion
+	std::vector<FlatNode> nodes;
+	std::vector<std::pair<aiNode*, int> > stack(1, std::make_pair(pScene->mRootNode, -1));
+	while (!stack.empty()) {
+		aiNode* const node = stack.back().first;
+		const int parent = stack.back().second;
+		stack.pop_back();
+		nodes.push_back(FlatNode(node, parent));
+		for (unsigned int n = node->mNumChildren; n > 0; --n) {
+			stack.push_back(std::make_pair(node->mChildren[n - 1], static_cast<int>(nodes.size()) - 1));
+		}
+	}
+
+	// children come after their parents, so going backwards marks everything above a dynamic node
+	const std::set<std::string> names = DynamicNodeNames(pScene);
+	nodes[0].kept = true;
+	for (size_t i = nodes.size(); i > 0; --i) {
+		FlatNode& entry = nodes[i - 1];
+		entry.kept = entry.kept || IsDynamic(pScene, *entry.node, names);
+		if (entry.kept && entry.parent >= 0) {
+			nodes[entry.parent].kept = true;
+		}
+	}
+
+	// and going forwards accumulates the transforms of removed nodes up to where their meshes go
+	const std::vector<unsigned int> refs = CountMeshReferences(pScene);
+	std::vector<std::vector<unsigned int> > meshes(nodes.size());
+	std::vector<aiMesh*> copies;
+	for (unsigned int i = 0; i < nodes.size(); ++i) {
+		FlatNode& entry = nodes[i];
+		if (entry.kept) {
+			meshes[i].assign(entry.node->mMeshes, entry.node->mMeshes + entry.node->mNumMeshes);
+			continue;
+		}
+
+		const FlatNode& parent = nodes[entry.parent];
+		entry.target = parent.kept ? entry.parent : parent.target;
+		entry.transform = parent.kept ? entry.node->mTransformation : parent.transform * entry.node->mTransformation;
+
+		for (unsigned int n = 0; n < entry.node->mNumMeshes; ++n) {
+			unsigned int index = entry.node->mMeshes[n];
+			if (refs[index] > 1) {
+				// other nodes still need the mesh as it is
+				copies.push_back(MergeMeshes(std::vector<const aiMesh*>(1, pScene->mMeshes[index])));
+				index = pScene->mNumMeshes + static_cast<unsigned int>(copies.size()) - 1;
+				BakeTransform(*copies.back(), entry.transform);
+			}
+			else {
+				BakeTransform(*pScene->mMeshes[index], entry.transform);
+			}
+			meshes[entry.target].push_back(index);
+		}
+	}
+
+	if (!copies.empty()) {
+		aiMesh** const all = new aiMesh*[pScene->mNumMeshes + copies.size()];
+		std::copy(pScene->mMeshes, pScene->mMeshes + pScene->mNumMeshes, all);
+		std::copy(copies.begin(), copies.end(), all + pScene->mNumMeshes);
+		delete[] pScene->mMeshes;
+		pScene->mMeshes = all;
+		pScene->mNumMeshes += static_cast<unsigned int>(copies.size());
+	}
+
+	// the children which stay, in their original order
+	std::vector<std::vector<aiNode*> > children(nodes.size());
+	for (unsigned int i = 1; i < nodes.size(); ++i) {
+		if (nodes[i].kept) {
+			children[nodes[i].parent].push_back(nodes[i].node);
+		}
+	}
+
+	// detach the removed nodes from the graph and from each other, so deleting them doesn't recurse
+	std::vector<aiNode*> removed;
+	for (unsigned int i = 0; i < nodes.size(); ++i) {
+		aiNode* const node = nodes[i].node;
+		if (!nodes[i].kept) {
+			node->mNumChildren = 0;
+			removed.push_back(node);
+			continue;
+		}
+		SetMeshes(node, meshes[i]);
+		node->mNumChildren = static_cast<unsigned int>(children[i].size());
+		std::copy(children[i].begin(), children[i].end(), node->mChildren);
+	}
+	for (unsigned int i = 0; i < removed.size(); ++i) {
+		delete removed[i];
+	}
+
+	RemoveUnreferencedMeshes(pScene);
+	MergeMeshesByMaterial(pScene, VERTEX_LIMIT);
+
+	nodesAfter = CountNodes(pScene->mRootNode);
+	drawCallsAfter = CountDrawCalls(pScene->mRootNode);
+
+	if (!Assimp::DefaultLogger::isNullLogger()) {
+		Assimp::DefaultLogger::get()->info("g3dj: flattening reduced nodes from " +
+			std::to_string(nodesBefore) + " to " + std::to_string(nodesAfter) + " and draw calls from " +
+			std::to_string(drawCallsBefore) + " to " + std::to_string(drawCallsAfter));
+	}
+}
@@ -0,0 +1,85 @@
+/*
+Assimp2Libgdx
+Copyright (c) 2017, Eugene Wang
+
+Licensed under a 3-clause BSD license. See the LICENSE file for more information.
+*/
+
+#ifndef INCLUDED_SCENE_FLATTENER
+#define INCLUDED_SCENE_FLATTENER
+
+struct aiScene;
+
+// ---------------------------------------------------------------------------
+/** Collapses the static parts of the node graph, so the runtime has fewer
+ *  nodes to walk and fewer draw calls to issue.
+ *
+ *  A node stays if it is the root, animated, a bone, a camera or a light,
+ *  if it has skinned or morphing meshes, or if any node below it stays.
+ *  All other nodes are removed: the transforms down to the nearest node
+ *  which stays are baked into the vertices of their meshes, which are then
+ *  attached to that node. Meshes of a node which share a material are
+ *  finally merged, as long as they stay within the vertex limit.
+ *
+ *  Meshes referenced by several nodes are copied for each static instance,
+ *  which trades file size for draw calls.
+ */
+class SceneFlattener
+{
+
+public:
+
+	SceneFlattener() : VERTEX_LIMIT(1 << 15),
+		nodesBefore(0), nodesAfter(0), drawCallsBefore(0), drawCallsAfter(0) {
+	}
+
+public:
+
+	// -------------------------------------------------------------------
+	/** Sets the number of vertices merged meshes may have at most */
+	void SetVertexLimit(unsigned int l) {
+		VERTEX_LIMIT = l;
+	}
+
+	unsigned int GetVertexLimit() const {
+		return VERTEX_LIMIT;
+	}
+
+public:
+
+	// -------------------------------------------------------------------
+	/** Executes the flattening step on the given scene.
+	 * @param pScene The scene to work at.
+	 */
+	void Execute(aiScene* pScene);
+
+	// -------------------------------------------------------------------
+	/** Nodes and draw calls of the scene before and after the last
+	 * Execute(), see CountNodes() and CountDrawCalls(). */
+	unsigned int GetNodesBefore() const {
+		return nodesBefore;
+	}
+
+	unsigned int GetNodesAfter() const {
+		return nodesAfter;
+	}
+
+	unsigned int GetDrawCallsBefore() const {
+		return drawCallsBefore;
+	}
+
+	unsigned int GetDrawCallsAfter() const {
+		return drawCallsAfter;
+	}
+
+private:
+
+	unsigned int VERTEX_LIMIT;
+
+	unsigned int nodesBefore;
+	unsigned int nodesAfter;
+	unsigned int drawCallsBefore;
+	unsigned int drawCallsAfter;
+};
+
+#endif // INCLUDED_SCENE_FLATTENER
@@ -0,0 +1,312 @@
+/*
+Assimp2Libgdx
+Copyright (c) 2017, Eugene Wang
+
+Licensed under a 3-clause BSD license. See the LICENSE file for more information.
+*/
+
+#include "scene_utils.h"
+
+#include <assimp/scene.h>
+
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+
+namespace {
+
+// ------------------------------------------------------------------------------------------------
+void CountMeshReferences(const aiNode* pNode, std::vector<unsigned int>& refs)
+{
+	for (unsigned int i = 0; i < pNode->mNumMeshes; ++i) {
+		++refs[pNode->mMeshes[i]];
+	}
+	for (unsigned int i = 0; i < pNode->mNumChildren; ++i) {
+		CountMeshReferences(pNode->mChildren[i], refs);
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+void RemapNodeMeshes(aiNode* pNode, const std::vector<unsigned int>& new_index)
+{
+	for (unsigned int i = 0; i < pNode->mNumMeshes; ++i) {
+		pNode->mMeshes[i] = new_index[pNode->mMeshes[i]];
+	}
+	for (unsigned int i = 0; i < pNode->mNumChildren; ++i) {
+		RemapNodeMeshes(pNode->mChildren[i], new_index);
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+unsigned int MergeNodeMeshes(aiScene* pScene, aiNode* pNode, unsigned int vertexLimit, 
+	const std::vector<unsigned int>& refs)
+{
+	unsigned int merged = 0;
+
+	// every group becomes one mesh, which takes the place of the first mesh of the group
+	std::vector<std::vector<unsigned int> > groups;
+	std::vector<unsigned int> group_vertices;
+	for (unsigned int i = 0; i < pNode->mNumMeshes; ++i) {
+		const unsigned int index = pNode->mMeshes[i];
+		const aiMesh* mesh = pScene->mMeshes[index];
+
+		bool added = false;
+		if (refs[index] == 1 && IsMergeable(*mesh)) {
+			for (unsigned int g = 0; g < groups.size() && !added; ++g) {
+				const aiMesh* first = pScene->mMeshes[groups[g][0]];
+				if (refs[groups[g][0]] == 1 && IsMergeable(*first) &&
+					first->mMaterialIndex == mesh->mMaterialIndex &&
+					HaveSameVertexFormat(*first, *mesh) &&
+					group_vertices[g] + mesh->mNumVertices <= vertexLimit) {
+					groups[g].push_back(index);
+					group_vertices[g] += mesh->mNumVertices;
+					added = true;
+				}
+			}
+		}
+		if (!added) {
+			groups.push_back(std::vector<unsigned int>(1, index));
+			group_vertices.push_back(mesh->mNumVertices);
+		}
+	}
+
+	if (groups.size() != pNode->mNumMeshes) {
+		delete[] pNode->mMeshes;
+		pNode->mNumMeshes = static_cast<unsigned int>(groups.size());
+		pNode->mMeshes = new unsigned int[pNode->mNumMeshes];
+
+		for (unsigned int g = 0; g < groups.size(); ++g) {
+			pNode->mMeshes[g] = groups[g][0];
+			if (groups[g].size() == 1) {
+				continue;
+			}
+
+			std::vector<const aiMesh*> meshes;
+			for (unsigned int i = 0; i < groups[g].size(); ++i) {
+				meshes.push_back(pScene->mMeshes[groups[g][i]]);
+			}
+			aiMesh* const out = MergeMeshes(meshes);
+			delete pScene->mMeshes[groups[g][0]];
+			pScene->mMeshes[groups[g][0]] = out;
+
+			// the other meshes of the group are no longer referenced by anyone,
+			// RemoveUnreferencedMeshes() takes care of them
+			merged += static_cast<unsigned int>(groups[g].size()) - 1;
+		}
+	}
+
+	for (unsigned int i = 0; i < pNode->mNumChildren; ++i) {
+		merged += MergeNodeMeshes(pScene, pNode->mChildren[i], vertexLimit, refs);
+	}
+	return merged;
+}
+
+} // 
+
+// ------------------------------------------------------------------------------------------------
+std::string GetMaterialString(const aiMaterialProperty& prop)
+{
+	if (prop.mType != aiPTI_String || prop.mDataLength < 5) {
+		return std::string();
+	}
+	uint32_t length;
+	memcpy(&length, prop.mData, sizeof(length));
+	length = std::min(length, prop.mDataLength - 5);
+	return std::string(prop.mData + 4, length);
+}
+
+// ------------------------------------------------------------------------------------------------
+bool HaveSameVertexFormat(const aiMesh& a, const aiMesh& b)
+{
+	if (a.HasPositions() != b.HasPositions() || a.HasNormals() != b.HasNormals() ||
+		a.HasTangentsAndBitangents() != b.HasTangentsAndBitangents()) {
+		return false;
+	}
+	for (unsigned int c = 0; c < AI_MAX_NUMBER_OF_COLOR_SETS; ++c) {
+		if (a.HasVertexColors(c) != b.HasVertexColors(c)) {
+			return false;
+		}
+	}
+	for (unsigned int c = 0; c < AI_MAX_NUMBER_OF_TEXTURECOORDS; ++c) {
+		if (a.HasTextureCoords(c) != b.HasTextureCoords(c) || 
+			(a.HasTextureCoords(c) && a.mNumUVComponents[c] != b.mNumUVComponents[c])) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// ------------------------------------------------------------------------------------------------
+bool IsMergeable(const aiMesh& mesh)
+{
+	return !mesh.HasBones() && !mesh.mNumAnimMeshes && mesh.HasPositions();
+}
+
+// ------------------------------------------------------------------------------------------------
+aiMesh* MergeMeshes(const std::vector<const aiMesh*>& meshes)
+{
+	const aiMesh* const first = meshes[0];
+
+	aiMesh* out = new aiMesh();
+	out->mName = first->mName;
+	out->mMaterialIndex = first->mMaterialIndex;
+	for (unsigned int i = 0; i < meshes.size(); ++i) {
+		out->mNumVertices += meshes[i]->mNumVertices;
+		out->mNumFaces += meshes[i]->mNumFaces;
+		out->mPrimitiveTypes |= meshes[i]->mPrimitiveTypes;
+	}
+
+	const unsigned int num = out->mNumVertices;
+	out->mVertices = new aiVector3D[num];
+	if (first->HasNormals()) {
+		out->mNormals = new aiVector3D[num];
+	}
+	if (first->HasTangentsAndBitangents()) {
+		out->mTangents = new aiVector3D[num];
+		out->mBitangents = new aiVector3D[num];
+	}
+	for (unsigned int c = 0; first->HasVertexColors(c); ++c) {
+		out->mColors[c] = new aiColor4D[num];
+	}
+	for (unsigned int c = 0; first->HasTextureCoords(c); ++c) {
+		out->mNumUVComponents[c] = first->mNumUVComponents[c];
+		out->mTextureCoords[c] = new aiVector3D[num];
+	}
+	out->mFaces = new aiFace[out->mNumFaces];
+
+	unsigned int base_vertex = 0, base_face = 0;
+	for (unsigned int i = 0; i < meshes.size(); ++i) {
+		const aiMesh* const in = meshes[i];
+		const unsigned int n = in->mNumVertices;
+
+		std::copy(in->mVertices, in->mVertices + n, out->mVertices + base_vertex);
+		if (out->mNormals) {
+			std::copy(in->mNormals, in->mNormals + n, out->mNormals + base_vertex);
+		}
+		if (out->mTangents) {
+			std::copy(in->mTangents, in->mTangents + n, out->mTangents + base_vertex);
+			std::copy(in->mBitangents, in->mBitangents + n, out->mBitangents + base_vertex);
+		}
+		for (unsigned int c = 0; out->HasVertexColors(c); ++c) {
+			std::copy(in->mColors[c], in->mColors[c] + n, out->mColors[c] + base_vertex);
+		}
+		for (unsigned int c = 0; out->HasTextureCoords(c); ++c) {
+			std::copy(in->mTextureCoords[c], in->mTextureCoords[c] + n, out->mTextureCoords[c] + base_vertex);
+		}
+
+		for (unsigned int f = 0; f < in->mNumFaces; ++f) {
+			const aiFace& face_in = in->mFaces[f];
+			aiFace& face_out = out->mFaces[base_face + f];
+			face_out.mNumIndices = face_in.mNumIndices;
+			face_out.mIndices = new unsigned int[face_in.mNumIndices];
+			for (unsigned int v = 0; v < face_in.mNumIndices; ++v) {
+				face_out.mIndices[v] = face_in.mIndices[v] + base_vertex;
+			}
+		}
+
+		base_vertex += n;
+		base_face += in->mNumFaces;
+	}
+	return out;
+}
+
+// ------------------------------------------------------------------------------------------------
+std::vector<unsigned int> CountMeshReferences(const aiScene* pScene)
+{
+	std::vector<unsigned int> refs(pScene->mNumMeshes, 0);
+	if (pScene->mRootNode) {
+		CountMeshReferences(pScene->mRootNode, refs);
+	}
+	return refs;
+}
+
+// ------------------------------------------------------------------------------------------------
+unsigned int MergeMeshesByMaterial(aiScene* pScene, unsigned int vertexLimit)
+{
+	if (!pScene->mRootNode) {
+		return 0;
+	}
+	const std::vector<unsigned int> refs = CountMeshReferences(pScene);
+	const unsigned int merged = MergeNodeMeshes(pScene, pScene->mRootNode, vertexLimit, refs);
+	if (merged) {
+		RemoveUnreferencedMeshes(pScene);
+	}
+	return merged;
+}
+
+// ------------------------------------------------------------------------------------------------
+void RemoveUnreferencedMeshes(aiScene* pScene)
+{
+	const std::vector<unsigned int> refs = CountMeshReferences(pScene);
+
+	std::vector<unsigned int> new_index(pScene->mNumMeshes, 0);
+	unsigned int size = 0;
+	for (unsigned int i = 0; i < pScene->mNumMeshes; ++i) {
+		if (!refs[i]) {
+			delete pScene->mMeshes[i];
+			continue;
+		}
+		new_index[i] = size;
+		pScene->mMeshes[size++] = pScene->mMeshes[i];
+	}
+
+	if (size != pScene->mNumMeshes) {
+		pScene->mNumMeshes = size;
+		if (pScene->mRootNode) {
+			RemapNodeMeshes(pScene->mRootNode, new_index);
+		}
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+void RemoveUnreferencedMaterials(aiScene* pScene)
+{
+	std::vector<bool> used(pScene->mNumMaterials, false);
+	for (unsigned int i = 0; i < pScene->mNumMeshes; ++i) {
+		used[pScene->mMeshes[i]->mMaterialIndex] = true;
+	}
+
+	std::vector<unsigned int> new_index(pScene->mNumMaterials, 0);
+	unsigned int size = 0;
+	for (unsigned int i = 0; i < pScene->mNumMaterials; ++i) {
+		if (!used[i]) {
+			delete pScene->mMaterials[i];
+			continue;
+		}
+		new_index[i] = size;
+		pScene->mMaterials[size++] = pScene->mMaterials[i];
+	}
+	pScene->mNumMaterials = size;
+
+	for (unsigned int i = 0; i < pScene->mNumMeshes; ++i) {
+		pScene->mMeshes[i]->mMaterialIndex = new_index[pScene->mMeshes[i]->mMaterialIndex];
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+unsigned int CountDrawCalls(const aiNode* pNode)
+{
+	unsigned int count = 0;
+	std::vector<const aiNode*> stack(1, pNode);
+	while (!stack.empty()) {
+		const aiNode* const node = stack.back();
+		stack.pop_back();
+		count += node->mNumMeshes;
+		stack.insert(stack.end(), node->mChildren, node->mChildren + node->mNumChildren);
+	}
+	return count;
+}
+
+// ------------------------------------------------------------------------------------------------
+unsigned int CountNodes(const aiNode* pNode)
+{
+	unsigned int count = 0;
+	std::vector<const aiNode*> stack(1, pNode);
+	while (!stack.empty()) {
+		const aiNode* const node = stack.back();
+		stack.pop_back();
+		++count;
+		stack.insert(stack.end(), node->mChildren, node->mChildren + node->mNumChildren);
+	}
+	return count;
+}
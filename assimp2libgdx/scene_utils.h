@@ -0,0 +1,80 @@
+/*
+Assimp2Libgdx
+Copyright (c) 2017, Eugene Wang
+
+Licensed under a 3-clause BSD license. See the LICENSE file for more information.
+*/
+
+#ifndef INCLUDED_SCENE_UTILS
+#define INCLUDED_SCENE_UTILS
+
+// ----------------------------------------------------------------------------
+// Helpers shared by the passes that restructure the scene before export,
+// and by the exporter itself.
+// ----------------------------------------------------------------------------
+
+#include <vector>
+#include <string>
+
+struct aiScene;
+struct aiMesh;
+struct aiNode;
+struct aiMaterialProperty;
+
+// ---------------------------------------------------------------------------
+/** Reads a string material property. These are stored as a 32 bit length
+ *  followed by the zero-terminated string, not as an aiString.
+ */
+std::string GetMaterialString(const aiMaterialProperty& prop);
+
+// ---------------------------------------------------------------------------
+/** Checks whether two meshes have the same vertex components, so their
+ *  vertices can be stored in one vertex buffer.
+ */
+bool HaveSameVertexFormat(const aiMesh& a, const aiMesh& b);
+
+// ---------------------------------------------------------------------------
+/** Checks whether a mesh may be merged with others at all. Meshes with bones
+ *  or morph targets are left alone.
+ */
+bool IsMergeable(const aiMesh& mesh);
+
+// ---------------------------------------------------------------------------
+/** Concatenates meshes with the same vertex format and material into a new
+ *  mesh. The name and material are taken from the first mesh.
+ */
+aiMesh* MergeMeshes(const std::vector<const aiMesh*>& meshes);
+
+// ---------------------------------------------------------------------------
+/** Counts how many nodes reference each mesh of the scene. */
+std::vector<unsigned int> CountMeshReferences(const aiScene* pScene);
+
+// ---------------------------------------------------------------------------
+/** Merges the meshes of every node that share a material, as long as the
+ *  merged mesh stays within vertexLimit vertices. Only meshes referenced by
+ *  a single node are merged, the meshes that were merged into others are
+ *  removed from the scene.
+ *  @return The number of meshes that were merged away
+ */
+unsigned int MergeMeshesByMaterial(aiScene* pScene, unsigned int vertexLimit);
+
+// ---------------------------------------------------------------------------
+/** Deletes all meshes not referenced by any node and updates the indices
+ *  in the node graph accordingly. */
+void RemoveUnreferencedMeshes(aiScene* pScene);
+
+// ---------------------------------------------------------------------------
+/** Deletes all materials no mesh refers to and updates the mesh material
+ *  indices accordingly. */
+void RemoveUnreferencedMaterials(aiScene* pScene);
+
+// ---------------------------------------------------------------------------
+/** Number of draw calls needed to render the node graph, which is one per
+ *  mesh reference. */
+unsigned int CountDrawCalls(const aiNode* pNode);
+
+// ---------------------------------------------------------------------------
+/** Number of nodes in the graph below and including pNode. */
+unsigned int CountNodes(const aiNode* pNode);
+
+#endif // INCLUDED_SCENE_UTILS
@@ -0,0 +1,405 @@
+/*
+Assimp2Libgdx
+Copyright (c) 2017, Eugene Wang
+
+Licensed under a 3-clause BSD license. See the LICENSE file for more information.
+*/
+
+#include "texture_atlas.h"
+#include "scene_utils.h"
+
+#include <assimp/scene.h>
+#include <assimp/DefaultLogger.hpp>
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+// texture coordinates may stray this far outside [0,1] before a mesh is considered to wrap
+const float UV_EPSILON = 1e-4f;
+
+// ------------------------------------------------------------------------------------------------
+// Index of the embedded texture referenced by a path of the form "*<index>", or -1
+int EmbeddedTextureIndex(const aiScene* pScene, const std::string& path)
+{
+	if (path.size() < 2 || path[0] != '*') {
+		return -1;
+	}
+	char* end;
+	const unsigned long index = strtoul(path.c_str() + 1, &end, 10);
+	if (*end != '\0' || index >= pScene->mNumTextures) {
+		return -1;
+	}
+	return static_cast<int>(index);
+}
+
+// ------------------------------------------------------------------------------------------------
+// Checks whether a material can go into an atlas. If so, returns the embedded texture 
+// it uses and sets signature to a key that is equal for materials which only differ 
+// in their diffuse texture.
+int AtlasCandidate(const aiScene* pScene, const aiMaterial& mat, unsigned int max_size, 
+	unsigned int padding, unsigned int& layer, std::string& signature)
+{
+	int texture = -1;
+	unsigned int num_textures = 0;
+	signature.clear();
+
+	for (unsigned int i = 0; i < mat.mNumProperties; ++i) {
+		const aiMaterialProperty& prop = *mat.mProperties[i];
+		const std::string key(prop.mKey.C_Str(), prop.mKey.length);
+
+		if (key == _AI_MATKEY_TEXTURE_BASE) {
+			if (prop.mSemantic != aiTextureType_DIFFUSE || ++num_textures > 1) {
+				return -1;
+			}
+			texture = EmbeddedTextureIndex(pScene, GetMaterialString(prop));
+			layer = prop.mIndex;
+			continue;
+		}
+		if (key == "$tex.uvwsrc") {
+			// only texture coordinate set 0 is rewritten
+			int channel;
+			memcpy(&channel, prop.mData, sizeof(channel));
+			if (channel != 0) {
+				return -1;
+			}
+			continue;
+		}
+		if (key == "$tex.uvtrafo") {
+			return -1;
+		}
+		if (!key.compare(0, 5, "$tex.")) {
+			// wrap modes and blending of the diffuse layer don't matter within [0,1]
+			continue;
+		}
+
+		signature += key;
+		signature.append(reinterpret_cast<const char*>(&prop.mSemantic), sizeof(prop.mSemantic));
+		signature.append(reinterpret_cast<const char*>(&prop.mIndex), sizeof(prop.mIndex));
+		signature.append(reinterpret_cast<const char*>(&prop.mType), sizeof(prop.mType));
+		signature.append(prop.mData, prop.mDataLength);
+	}
+
+	if (texture < 0) {
+		return -1;
+	}
+
+	// only raw texel data can be copied into an atlas
+	const aiTexture& tex = *pScene->mTextures[texture];
+	if (!tex.mHeight || tex.mWidth + 2 * padding > max_size || tex.mHeight + 2 * padding > max_size) {
+		return -1;
+	}
+	return texture;
+}
+
+// ------------------------------------------------------------------------------------------------
+bool HasUnitTextureCoords(const aiMesh& mesh)
+{
+	if (!mesh.HasTextureCoords(0) || mesh.mNumUVComponents[0] < 2) {
+		return false;
+	}
+	for (unsigned int i = 0; i < mesh.mNumVertices; ++i) {
+		const aiVector3D& uv = mesh.mTextureCoords[0][i];
+		if (uv.x < -UV_EPSILON || uv.x > 1.f + UV_EPSILON || uv.y < -UV_EPSILON || uv.y > 1.f + UV_EPSILON) {
+			return false;
+		}
+	}
+	return true;
+}
+
+struct Placement 
+{
+	unsigned int texture;
+	unsigned int x, y; // top left corner of the texture, excluding padding
+};
+
+struct Atlas 
+{
+	unsigned int width, height;
+	std::vector<Placement> placements;
+};
+
+unsigned int NextPowerOfTwo(unsigned int v)
+{
+	unsigned int p = 1;
+	while (p < v) {
+		p <<= 1;
+	}
+	return p;
+}
+
+// ------------------------------------------------------------------------------------------------
+// Simple shelf packing, textures are expected to be sorted by decreasing height
+std::vector<Atlas> Pack(const aiScene* pScene, const std::vector<unsigned int>& textures, 
+	unsigned int max_size, unsigned int padding)
+{
+	std::vector<Atlas> atlases;
+	unsigned int shelf_x = 0, shelf_y = 0, shelf_height = 0;
+	for (unsigned int i = 0; i < textures.size(); ++i) {
+		const aiTexture& tex = *pScene->mTextures[textures[i]];
+		const unsigned int w = tex.mWidth + 2 * padding, h = tex.mHeight + 2 * padding;
+
+		if (!atlases.empty() && shelf_x + w > max_size) {
+			// start a new shelf
+			shelf_y += shelf_height;
+			shelf_x = shelf_height = 0;
+		}
+		if (atlases.empty() || shelf_y + h > max_size) {
+			atlases.push_back(Atlas());
+			atlases.back().width = atlases.back().height = 0;
+			shelf_x = shelf_y = shelf_height = 0;
+		}
+
+		Atlas& atlas = atlases.back();
+		Placement p;
+		p.texture = textures[i];
+		p.x = shelf_x + padding;
+		p.y = shelf_y + padding;
+		atlas.placements.push_back(p);
+
+		shelf_x += w;
+		shelf_height = std::max(shelf_height, h);
+		atlas.width = std::max(atlas.width, shelf_x);
+		atlas.height = std::max(atlas.height, shelf_y + shelf_height);
+	}
+
+	// power of two sizes keep mipmapping and wrapping available on all GL ES targets
+	for (unsigned int i = 0; i < atlases.size(); ++i) {
+		atlases[i].width = NextPowerOfTwo(atlases[i].width);
+		atlases[i].height = NextPowerOfTwo(atlases[i].height);
+	}
+	return atlases;
+}
+
+// ------------------------------------------------------------------------------------------------
+// Copies all textures into a new texture, extending their borders into the padding 
+// so filtering doesn't pick up the neighbouring textures
+aiTexture* BuildAtlasTexture(const aiScene* pScene, const Atlas& atlas, unsigned int padding)
+{
+	aiTexture* out = new aiTexture();
+	out->mWidth = atlas.width;
+	out->mHeight = atlas.height;
+	out->pcData = new aiTexel[atlas.width * atlas.height];
+	memset(out->pcData, 0, atlas.width * atlas.height * sizeof(aiTexel));
+
+	for (unsigned int i = 0; i < atlas.placements.size(); ++i) {
+		const Placement& p = atlas.placements[i];
+		const aiTexture& tex = *pScene->mTextures[p.texture];
+		const int w = tex.mWidth, h = tex.mHeight, pad = padding;
+
+		for (int y = -pad; y < h + pad; ++y) {
+			const int sy = std::min(std::max(y, 0), h - 1);
+			aiTexel* const row = out->pcData + (p.y + y) * atlas.width + p.x;
+			for (int x = -pad; x < w + pad; ++x) {
+				const int sx = std::min(std::max(x, 0), w - 1);
+				row[x] = tex.pcData[sy * w + sx];
+			}
+		}
+	}
+	return out;
+}
+
+// ------------------------------------------------------------------------------------------------
+template <typename T>
+unsigned int Append(T**& array, unsigned int& num, T* item)
+{
+	T** const grown = new T*[num + 1];
+	std::copy(array, array + num, grown);
+	grown[num] = item;
+	delete[] array;
+	array = grown;
+	return num++;
+}
+
+// ------------------------------------------------------------------------------------------------
+// Drops the embedded textures no material refers to any longer, and renumbers the
+// "*<index>" references of the remaining ones
+void RemoveUnreferencedTextures(aiScene* pScene)
+{
+	std::vector<bool> used(pScene->mNumTextures, false);
+	for (unsigned int m = 0; m < pScene->mNumMaterials; ++m) {
+		const aiMaterial& mat = *pScene->mMaterials[m];
+		for (unsigned int i = 0; i < mat.mNumProperties; ++i) {
+			if (!strcmp(mat.mProperties[i]->mKey.C_Str(), _AI_MATKEY_TEXTURE_BASE)) {
+				const int index = EmbeddedTextureIndex(pScene, GetMaterialString(*mat.mProperties[i]));
+				if (index >= 0) {
+					used[index] = true;
+				}
+			}
+		}
+	}
+
+	std::vector<unsigned int> new_index(pScene->mNumTextures, 0);
+	unsigned int size = 0;
+	for (unsigned int i = 0; i < pScene->mNumTextures; ++i) {
+		if (!used[i]) {
+			delete pScene->mTextures[i];
+			continue;
+		}
+		new_index[i] = size;
+		pScene->mTextures[size++] = pScene->mTextures[i];
+	}
+	if (size == pScene->mNumTextures) {
+		return;
+	}
+
+	for (unsigned int m = 0; m < pScene->mNumMaterials; ++m) {
+		aiMaterial& mat = *pScene->mMaterials[m];
+		for (unsigned int i = 0; i < mat.mNumProperties; ++i) {
+			const aiMaterialProperty& prop = *mat.mProperties[i];
+			if (strcmp(prop.mKey.C_Str(), _AI_MATKEY_TEXTURE_BASE)) {
+				continue;
+			}
+			const int index = EmbeddedTextureIndex(pScene, GetMaterialString(prop));
+			if (index >= 0) {
+				const aiString path("*" + std::to_string(new_index[index]));
+				// replaces the existing property, but keeps its position
+				mat.AddProperty(&path, _AI_MATKEY_TEXTURE_BASE, prop.mSemantic, prop.mIndex);
+			}
+		}
+	}
+	pScene->mNumTextures = size;
+}
+
+} // 
+
+// ------------------------------------------------------------------------------------------------
+// Executes the atlas step on the given scene.
+void TextureAtlasBuilder :: Execute( aiScene* pScene)
+{
+	drawCallsBefore = drawCallsAfter = pScene->mRootNode ? CountDrawCalls(pScene->mRootNode) : 0;
+	if (!pScene->mNumTextures || !pScene->mNumMaterials) {
+		return;
+	}
+
+	// find the materials which qualify, and group them by everything but their diffuse texture
+	std::vector<int> material_texture(pScene->mNumMaterials, -1);
+	std::vector<unsigned int> material_layer(pScene->mNumMaterials, 0);
+	std::vector<std::string> signatures(pScene->mNumMaterials);
+	for (unsigned int m = 0; m < pScene->mNumMaterials; ++m) {
+		material_texture[m] = AtlasCandidate(pScene, *pScene->mMaterials[m], MAX_SIZE, PADDING, material_layer[m], signatures[m]);
+	}
+	for (unsigned int i = 0; i < pScene->mNumMeshes; ++i) {
+		const aiMesh& mesh = *pScene->mMeshes[i];
+		if (material_texture[mesh.mMaterialIndex] >= 0 && !HasUnitTextureCoords(mesh)) {
+			material_texture[mesh.mMaterialIndex] = -1;
+		}
+	}
+
+	std::map<std::string, std::vector<unsigned int> > groups;
+	for (unsigned int m = 0; m < pScene->mNumMaterials; ++m) {
+		if (material_texture[m] >= 0) {
+			groups[signatures[m]].push_back(m);
+		}
+	}
+
+	// material of every mesh after packing, and where in the atlas its texture went
+	std::vector<unsigned int> new_material(pScene->mNumMaterials);
+	std::vector<const Placement*> placement(pScene->mNumMaterials, nullptr);
+	std::vector<const Atlas*> material_atlas(pScene->mNumMaterials, nullptr);
+	for (unsigned int m = 0; m < pScene->mNumMaterials; ++m) {
+		new_material[m] = m;
+	}
+
+	// keeps the placements alive until the meshes are updated
+	std::vector<std::vector<Atlas> > all_atlases;
+	all_atlases.reserve(groups.size());
+
+	for (std::map<std::string, std::vector<unsigned int> >::const_iterator it = groups.begin(); it != groups.end(); ++it) {
+		const std::vector<unsigned int>& materials = it->second;
+		if (materials.size() < 2) {
+			continue;
+		}
+
+		std::vector<unsigned int> textures;
+		for (unsigned int i = 0; i < materials.size(); ++i) {
+			textures.push_back(material_texture[materials[i]]);
+		}
+		std::sort(textures.begin(), textures.end());
+		textures.erase(std::unique(textures.begin(), textures.end()), textures.end());
+
+		const aiScene* const scene = pScene;
+		std::stable_sort(textures.begin(), textures.end(), [scene](unsigned int a, unsigned int b) {
+			return scene->mTextures[a]->mHeight > scene->mTextures[b]->mHeight;
+		});
+
+		all_atlases.push_back(Pack(pScene, textures, MAX_SIZE, PADDING));
+		const std::vector<Atlas>& atlases = all_atlases.back();
+
+		for (unsigned int a = 0; a < atlases.size(); ++a) {
+			const Atlas& atlas = atlases[a];
+
+			// materials whose texture went into this atlas
+			std::vector<unsigned int> users;
+			for (unsigned int i = 0; i < materials.size(); ++i) {
+				for (unsigned int p = 0; p < atlas.placements.size(); ++p) {
+					if (atlas.placements[p].texture == static_cast<unsigned int>(material_texture[materials[i]])) {
+						users.push_back(materials[i]);
+						placement[materials[i]] = &atlas.placements[p];
+					}
+				}
+			}
+			if (users.size() < 2) {
+				continue;
+			}
+
+			unsigned int target = users[0];
+			if (atlas.placements.size() > 1) {
+				const unsigned int texture = Append(pScene->mTextures, pScene->mNumTextures, BuildAtlasTexture(pScene, atlas, PADDING));
+
+				aiMaterial* const mat = new aiMaterial();
+				aiMaterial::CopyPropertyList(mat, pScene->mMaterials[users[0]]);
+				const aiString path("*" + std::to_string(texture));
+				mat->AddProperty(&path, _AI_MATKEY_TEXTURE_BASE, aiTextureType_DIFFUSE, material_layer[users[0]]);
+				target = Append(pScene->mMaterials, pScene->mNumMaterials, mat);
+
+				for (unsigned int i = 0; i < users.size(); ++i) {
+					material_atlas[users[i]] = &atlas;
+				}
+			}
+			// else all of them use the very same texture, they can simply share the first material
+
+			for (unsigned int i = 0; i < users.size(); ++i) {
+				new_material[users[i]] = target;
+			}
+		}
+	}
+
+	// move the texture coordinates of all affected meshes into the atlas
+	for (unsigned int i = 0; i < pScene->mNumMeshes; ++i) {
+		aiMesh& mesh = *pScene->mMeshes[i];
+		const unsigned int m = mesh.mMaterialIndex;
+		if (material_atlas[m]) {
+			const Atlas& atlas = *material_atlas[m];
+			const Placement& p = *placement[m];
+			const aiTexture& tex = *pScene->mTextures[p.texture];
+
+			// texel rows go top to bottom, v goes bottom to top
+			const float su = float(tex.mWidth) / atlas.width, sv = float(tex.mHeight) / atlas.height;
+			const float ou = float(p.x) / atlas.width, ov = float(atlas.height - p.y - tex.mHeight) / atlas.height;
+			for (unsigned int v = 0; v < mesh.mNumVertices; ++v) {
+				aiVector3D& uv = mesh.mTextureCoords[0][v];
+				uv.x = ou + uv.x * su;
+				uv.y = ov + uv.y * sv;
+			}
+		}
+		mesh.mMaterialIndex = new_material[m];
+	}
+
+	if (pScene->mRootNode) {
+		MergeMeshesByMaterial(pScene, VERTEX_LIMIT);
+		drawCallsAfter = CountDrawCalls(pScene->mRootNode);
+	}
+	RemoveUnreferencedMaterials(pScene);
+	RemoveUnreferencedTextures(pScene);
+
+	if (!Assimp::DefaultLogger::isNullLogger()) {
+		Assimp::DefaultLogger::get()->info("g3dj: texture atlas reduced draw calls from " + 
+			std::to_string(drawCallsBefore) + " to " + std::to_string(drawCallsAfter));
+	}
+}
@@ -0,0 +1,86 @@
+/*
+Assimp2Libgdx
+Copyright (c) 2017, Eugene Wang
+
+Licensed under a 3-clause BSD license. See the LICENSE file for more information.
+*/
+
+#ifndef INCLUDED_TEXTURE_ATLAS
+#define INCLUDED_TEXTURE_ATLAS
+
+struct aiScene;
+
+// ---------------------------------------------------------------------------
+/** Packs the diffuse textures of otherwise identical materials into atlases,
+ *  so the meshes using them can share one material and be merged into a
+ *  single draw call.
+ *
+ *  Only uncompressed embedded textures are packed, as they are the only 
+ *  pixel data available without an image codec. A material qualifies if 
+ *  its only texture is such a diffuse texture, and all meshes using it 
+ *  keep their texture coordinates within [0,1], so no wrapping is needed.
+ *  Texture coordinates of affected meshes are rewritten to address the
+ *  atlas, and meshes of the same node which now share a material are
+ *  merged as long as they stay within the vertex limit.
+ */
+class TextureAtlasBuilder
+{
+
+public:
+
+	TextureAtlasBuilder() : MAX_SIZE(2048), PADDING(2), VERTEX_LIMIT(1 << 15), 
+		drawCallsBefore(0), drawCallsAfter(0) {
+	}
+
+public:
+
+	// -------------------------------------------------------------------
+	/** Sets the maximum width and height of an atlas, in texels */
+	void SetMaxSize(unsigned int s) {
+		MAX_SIZE = s;
+	}
+
+	unsigned int GetMaxSize() const {
+		return MAX_SIZE;
+	}
+
+	// -------------------------------------------------------------------
+	/** Sets the number of vertices merged meshes may have at most */
+	void SetVertexLimit(unsigned int l) {
+		VERTEX_LIMIT = l;
+	}
+
+	unsigned int GetVertexLimit() const {
+		return VERTEX_LIMIT;
+	}
+
+public:
+
+	// -------------------------------------------------------------------
+	/** Executes the atlas step on the given scene.
+	 * @param pScene The scene to work at.
+	 */
+	void Execute(aiScene* pScene);
+
+	// -------------------------------------------------------------------
+	/** Draw calls needed to render the scene before and after the last
+	 * Execute(), see CountDrawCalls(). */
+	unsigned int GetDrawCallsBefore() const {
+		return drawCallsBefore;
+	}
+
+	unsigned int GetDrawCallsAfter() const {
+		return drawCallsAfter;
+	}
+
+private:
+
+	unsigned int MAX_SIZE;
+	unsigned int PADDING;
+	unsigned int VERTEX_LIMIT;
+
+	unsigned int drawCallsBefore;
+	unsigned int drawCallsAfter;
+};
+
+#endif // INCLUDED_TEXTURE_ATLAS
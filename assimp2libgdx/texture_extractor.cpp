@@ -0,0 +1,162 @@
+/*
+Assimp2Libgdx
+Copyright (c) 2017, Eugene Wang
+
+Licensed under a 3-clause BSD license. See the LICENSE file for more information.
+*/
+
+#include "texture_extractor.h"
+#include "content_hash.h"
+
+#include <assimp/scene.h>
+#include <assimp/IOStream.hpp>
+#include <assimp/IOSystem.hpp>
+#include <assimp/DefaultLogger.hpp>
+
+#include <algorithm>
+#include <memory>
+#include <cctype>
+
+namespace {
+
+// ------------------------------------------------------------------------------------------------
+// Picks a file extension for a compressed texture from its format hint
+std::string ExtensionFromHint(const aiTexture& tex)
+{
+	std::string ext;
+	for (unsigned int i = 0; i < sizeof(tex.achFormatHint) && tex.achFormatHint[i]; ++i) {
+		const char c = tex.achFormatHint[i];
+		if (!isalnum(static_cast<unsigned char>(c))) {
+			break;
+		}
+		ext.push_back(static_cast<char>(tolower(static_cast<unsigned char>(c))));
+	}
+	return ext.empty() ? "bin" : ext;
+}
+
+// ------------------------------------------------------------------------------------------------
+// Stores an uncompressed texture as a 32 bit, top-left origin tga. aiTexel is 
+// BGRA, which is exactly tga's pixel layout, so the texels are copied as they are.
+bool EncodeTGA(const aiTexture& tex, std::vector<unsigned char>& data)
+{
+	if (tex.mWidth > 0xffff || tex.mHeight > 0xffff) {
+		return false;
+	}
+
+	unsigned char header[18] = {0};
+	header[2] = 2; // uncompressed true-color
+	header[12] = tex.mWidth & 0xff;
+	header[13] = (tex.mWidth >> 8) & 0xff;
+	header[14] = tex.mHeight & 0xff;
+	header[15] = (tex.mHeight >> 8) & 0xff;
+	header[16] = 32;
+	header[17] = 0x28; // 8 alpha bits, top-left origin
+
+	const size_t texels = static_cast<size_t>(tex.mWidth) * tex.mHeight;
+	data.resize(sizeof(header) + texels * 4);
+	std::copy(header, header + sizeof(header), data.begin());
+	for (size_t i = 0; i < texels; ++i) {
+		unsigned char* const px = &data[sizeof(header) + i * 4];
+		px[0] = tex.pcData[i].b;
+		px[1] = tex.pcData[i].g;
+		px[2] = tex.pcData[i].r;
+		px[3] = tex.pcData[i].a;
+	}
+	return true;
+}
+
+} // 
+
+// ------------------------------------------------------------------------------------------------
+TextureExtractor :: TextureExtractor()
+	: scene(nullptr)
+	, io(nullptr)
+	, next(0)
+{
+}
+
+// ------------------------------------------------------------------------------------------------
+TextureExtractor :: ~TextureExtractor()
+{
+	Wait();
+}
+
+// ------------------------------------------------------------------------------------------------
+void TextureExtractor :: Start(const aiScene* pScene, Assimp::IOSystem* pIOSystem, const std::string& dir)
+{
+	scene = pScene;
+	io = pIOSystem;
+	directory = dir;
+	next = 0;
+
+	fileNames.clear();
+	fileNames.resize(pScene->mNumTextures);
+	if (!pScene->mNumTextures) {
+		return;
+	}
+
+	const unsigned int hardware = std::max(1u, std::thread::hardware_concurrency());
+	const unsigned int num_workers = std::min(hardware, pScene->mNumTextures);
+	for (unsigned int i = 0; i < num_workers; ++i) {
+		workers.push_back(std::thread(&TextureExtractor::Work, this));
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+void TextureExtractor :: Wait()
+{
+	for (unsigned int i = 0; i < workers.size(); ++i) {
+		workers[i].join();
+	}
+	workers.clear();
+}
+
+// ------------------------------------------------------------------------------------------------
+void TextureExtractor :: Work()
+{
+	for (unsigned int index = next++; index < scene->mNumTextures; index = next++) {
+		Extract(index);
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+void TextureExtractor :: Extract(unsigned int index)
+{
+	const aiTexture& tex = *scene->mTextures[index];
+
+	// compressed textures are stored with mHeight == 0 and mWidth holding the size in bytes
+	std::vector<unsigned char> encoded;
+	const unsigned char* data;
+	size_t size;
+	std::string ext;
+	if (tex.mHeight == 0) {
+		data = reinterpret_cast<const unsigned char*>(tex.pcData);
+		size = tex.mWidth;
+		ext = ExtensionFromHint(tex);
+	}
+	else {
+		if (!EncodeTGA(tex, encoded)) {
+			std::lock_guard<std::mutex> lock(ioMutex);
+			Assimp::DefaultLogger::get()->warn("g3dj: embedded texture *" + std::to_string(index) + " is too large to be stored as tga");
+			return;
+		}
+		data = encoded.data();
+		size = encoded.size();
+		ext = "tga";
+	}
+
+	ContentHash hash;
+	hash.Update(data, size);
+	const std::string name = hash.HexDigest() + "." + ext;
+
+	std::lock_guard<std::mutex> lock(ioMutex);
+	if (written.insert(name).second) {
+		std::unique_ptr<Assimp::IOStream> file(io->Open(directory + name, "wb"));
+		if (!file || file->Write(data, 1, size) != size) {
+			Assimp::DefaultLogger::get()->warn("g3dj: failed to write embedded texture to " + directory + name);
+			written.erase(name);
+			return;
+		}
+	}
+	fileNames[index] = name;
+}
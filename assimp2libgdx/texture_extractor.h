@@ -0,0 +1,91 @@
+/*
+Assimp2Libgdx
+Copyright (c) 2017, Eugene Wang
+
+Licensed under a 3-clause BSD license. See the LICENSE file for more information.
+*/
+
+#ifndef INCLUDED_TEXTURE_EXTRACTOR
+#define INCLUDED_TEXTURE_EXTRACTOR
+
+#include <string>
+#include <vector>
+#include <set>
+#include <thread>
+#include <mutex>
+#include <atomic>
+
+struct aiScene;
+struct aiTexture;
+
+namespace Assimp {
+	class IOSystem;
+}
+
+// ---------------------------------------------------------------------------
+/** Writes the textures embedded in a scene out to separate files.
+ *
+ *  Files are named after a hash of their content, so identical textures
+ *  end up in a single file. Compressed textures (png, jpg, ...) are written
+ *  as they are, uncompressed ones are stored as 32 bit tga. 
+ *
+ *  Encoding and writing happens on worker threads, so it can overlap with
+ *  the serialization of the rest of the scene. All file access through the
+ *  IOSystem is serialized.
+ */
+class TextureExtractor
+{
+
+public:
+
+	TextureExtractor();
+	~TextureExtractor();
+
+public:
+
+	// -------------------------------------------------------------------
+	/** Starts writing the embedded textures of pScene into directory.
+	 * The scene must stay alive until Wait() returned.
+	 * @param pScene The scene whose mTextures are written
+	 * @param pIOSystem IOSystem used to create the files
+	 * @param directory Prefix for the file names, including the trailing separator
+	 */
+	void Start(const aiScene* pScene, Assimp::IOSystem* pIOSystem, const std::string& directory);
+
+	// -------------------------------------------------------------------
+	/** Blocks until all textures have been written. */
+	void Wait();
+
+	// -------------------------------------------------------------------
+	/** Returns the file name (without directory) the n-th embedded texture
+	 * was written to, or an empty string if it could not be written.
+	 * Only valid after Wait().
+	 */
+	const std::string& GetFileName(unsigned int index) const {
+		return fileNames[index];
+	}
+
+	unsigned int GetNumTextures() const {
+		return static_cast<unsigned int>(fileNames.size());
+	}
+
+private:
+
+	void Work();
+	void Extract(unsigned int index);
+
+private:
+
+	const aiScene* scene;
+	Assimp::IOSystem* io;
+	std::string directory;
+
+	std::vector<std::thread> workers;
+	std::atomic<unsigned int> next;
+	std::vector<std::string> fileNames;
+
+	std::mutex ioMutex;
+	std::set<std::string> written;
+};
+
+#endif // INCLUDED_TEXTURE_EXTRACTOR
@@ -0,0 +1,157 @@
+/*
+Assimp2Libgdx
+Copyright (c) 2017, Eugene Wang
+
+Licensed under a 3-clause BSD license. See the LICENSE file for more information.
+*/
+
+#include "triangle_strips.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+
+namespace {
+
+// state of triangles which are in the result, see GenerateTriangleStrip()
+const unsigned int Drawn = 1;
+
+// ------------------------------------------------------------------------------------------------
+// Finds the triangles next to each other along directed edges. A strip continues across the
+// edge between its last two indices, with the direction alternating from triangle to triangle.
+// Triangles are listed per vertex, which is faster to search than a map of all edges.
+class Adjacency
+{
+public:
+
+	explicit Adjacency(const std::vector<unsigned int>& triangles) : triangles(triangles) {
+		const unsigned int numVertices = triangles.empty() ? 0 : *std::max_element(triangles.begin(), triangles.end()) + 1;
+		first.assign(numVertices + 1, 0);
+		for (unsigned int i = 0; i < triangles.size(); ++i) {
+			++first[triangles[i] + 1];
+		}
+		for (unsigned int v = 0; v < numVertices; ++v) {
+			first[v + 1] += first[v];
+		}
+		std::vector<unsigned int> next(first.begin(), first.end() - 1);
+		users.resize(triangles.size());
+		for (unsigned int i = 0; i < triangles.size(); ++i) {
+			users[next[triangles[i]]++] = i / 3;
+		}
+	}
+
+	// a triangle with the edge from -> to which available() accepts, along with its third index, or -1
+	template <typename Predicate>
+	int Find(unsigned int from, unsigned int to, unsigned int& third, Predicate available) const {
+		for (unsigned int i = first[from]; i < first[from + 1]; ++i) {
+			const unsigned int t = users[i];
+			const unsigned int* v = &triangles[t * 3];
+			for (unsigned int k = 0; k < 3; ++k) {
+				if (v[k] == from && v[(k + 1) % 3] == to && available(t)) {
+					third = v[(k + 2) % 3];
+					return static_cast<int>(t);
+				}
+			}
+		}
+		return -1;
+	}
+
+private:
+	const std::vector<unsigned int>& triangles;
+	std::vector<unsigned int> first; // users of vertex v are users[first[v]] to users[first[v + 1]]
+	std::vector<unsigned int> users;
+};
+
+// ------------------------------------------------------------------------------------------------
+// A strip along with the triangles it draws
+struct Strip
+{
+	std::vector<unsigned int> indices;
+	std::vector<unsigned int> triangles;
+};
+
+// ------------------------------------------------------------------------------------------------
+// Grows a strip from its first triangle. Triangles are taken if they aren't drawn yet (0), and
+// weren't taken by this try already; taken ones are marked with stamp.
+void GrowStrip(const Adjacency& adjacency, std::vector<unsigned int>& state, unsigned int stamp, Strip& strip)
+{
+	for (;;) {
+		const std::vector<unsigned int>& s = strip.indices;
+		const size_t n = s.size();
+		// triangle n - 2 is drawn reversed when n is odd
+		const unsigned int from = n % 2 ? s[n - 1] : s[n - 2];
+		const unsigned int to = n % 2 ? s[n - 2] : s[n - 1];
+		unsigned int third;
+		const int t = adjacency.Find(from, to, third, [&state, stamp](unsigned int t) {
+			return state[t] != Drawn && state[t] != stamp;
+		});
+		if (t < 0) {
+			return;
+		}
+		state[t] = stamp;
+		strip.triangles.push_back(static_cast<unsigned int>(t));
+		strip.indices.push_back(third);
+	}
+}
+
+inline bool IsDegenerate(const unsigned int* v)
+{
+	return v[0] == v[1] || v[1] == v[2] || v[0] == v[2];
+}
+
+} //
+
+// ------------------------------------------------------------------------------------------------
+std::vector<unsigned int> GenerateTriangleStrip(const std::vector<unsigned int>& triangles)
+{
+	const unsigned int count = static_cast<unsigned int>(triangles.size() / 3);
+	const Adjacency adjacency(triangles);
+
+	// triangles are drawn, not drawn yet (0), or carry the stamp of the last try which took them
+	std::vector<unsigned int> state(count, 0);
+	unsigned int stamp = Drawn;
+
+	std::vector<unsigned int> result;
+	result.reserve(triangles.size() / 2);
+	Strip strip, best;
+	for (unsigned int t = 0; t < count; ++t) {
+		const unsigned int* v = &triangles[t * 3];
+		if (state[t] == Drawn) {
+			continue;
+		}
+		if (IsDegenerate(v)) {
+			state[t] = Drawn;
+			continue;
+		}
+
+		// start with every edge of the triangle in turn, and keep the longest strip
+		best.indices.clear();
+		for (unsigned int k = 0; k < 3; ++k) {
+			state[t] = ++stamp;
+			strip.triangles.assign(1, t);
+			strip.indices.assign(1, v[k]);
+			strip.indices.push_back(v[(k + 1) % 3]);
+			strip.indices.push_back(v[(k + 2) % 3]);
+			GrowStrip(adjacency, state, stamp, strip);
+			if (strip.indices.size() > best.indices.size()) {
+				std::swap(strip, best);
+			}
+		}
+		for (unsigned int i = 0; i < best.triangles.size(); ++i) {
+			state[best.triangles[i]] = Drawn;
+		}
+
+		// join with degenerate triangles, such that the strip starts at an even position and keeps its winding
+		const std::vector<unsigned int>& s = best.indices;
+		if (!result.empty()) {
+			const unsigned int last = result.back();
+			result.push_back(last);
+			result.push_back(s[0]);
+			if (result.size() % 2) {
+				result.push_back(s[0]);
+			}
+		}
+		result.insert(result.end(), s.begin(), s.end());
+	}
+	return result;
+}
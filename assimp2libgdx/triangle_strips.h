@@ -0,0 +1,30 @@
+/*
+Assimp2Libgdx
+Copyright (c) 2017, Eugene Wang
+
+Licensed under a 3-clause BSD license. See the LICENSE file for more information.
+*/
+
+#ifndef INCLUDED_TRIANGLE_STRIPS
+#define INCLUDED_TRIANGLE_STRIPS
+
+// ----------------------------------------------------------------------------
+// Conversion of triangle lists into triangle strips, which take close to one
+// index per triangle instead of three on meshes with good connectivity.
+// ----------------------------------------------------------------------------
+
+#include <vector>
+
+// ---------------------------------------------------------------------------
+/** Turns a list of triangles, three indices each, into a single triangle
+ *  strip drawing the same triangles with the same winding.
+ *
+ *  Strips are grown greedily across shared edges, starting from the first
+ *  triangle not drawn yet, and joined by degenerate triangles, so they need
+ *  no primitive restart. Every triangle is drawn exactly once; degenerate
+ *  input triangles are dropped. On meshes with poor connectivity the strip
+ *  can take more indices than the list, callers should compare sizes.
+ */
+std::vector<unsigned int> GenerateTriangleStrip(const std::vector<unsigned int>& triangles);
+
+#endif // INCLUDED_TRIANGLE_STRIPS
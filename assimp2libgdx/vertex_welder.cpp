@@ -0,0 +1,323 @@
+/*
+Assimp2Libgdx
+Copyright (c) 2017, Eugene Wang
+
+Licensed under a 3-clause BSD license. See the LICENSE file for more information.
+*/
+
+#include "vertex_welder.h"
+#include "bounds.h"
+
+#include <assimp/scene.h>
+#include <assimp/DefaultLogger.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace {
+
+const unsigned int NONE = 0xffffffff;
+
+// ------------------------------------------------------------------------------------------------
+// Positions hashed by the cell of a grid they are in. Cells are four epsilons wide, so the
+// neighbourhood of a position covers one or two cells along every axis. Cells are kept in an
+// open addressing table, which takes about half the time of a node based map.
+class SpatialHash
+{
+public:
+
+	SpatialHash(float epsilon, unsigned int capacity) : epsilon(epsilon), size(4.0 * epsilon), shift(64), next(capacity, NONE) {
+		size_t slots = 16;
+		while (slots < static_cast<size_t>(capacity) * 2) {
+			slots *= 2;
+		}
+		for (size_t s = slots; s > 1; s /= 2) {
+			--shift;
+		}
+		keys.resize(slots);
+		heads.resize(slots, NONE);
+	}
+
+	// calls visit(vertex) for the vertices inserted near p, until it returns true
+	template <typename Visitor>
+	void Find(const aiVector3D& p, Visitor visit) const {
+		const int64_t x1 = Cell(p.x + epsilon), y1 = Cell(p.y + epsilon), z1 = Cell(p.z + epsilon);
+		for (int64_t z = Cell(p.z - epsilon); z <= z1; ++z) {
+			for (int64_t y = Cell(p.y - epsilon); y <= y1; ++y) {
+				for (int64_t x = Cell(p.x - epsilon); x <= x1; ++x) {
+					for (unsigned int v = heads[Slot(Key(x, y, z))]; v != NONE; v = next[v]) {
+						if (visit(v)) {
+							return;
+						}
+					}
+				}
+			}
+		}
+	}
+
+	void Insert(const aiVector3D& p, unsigned int vertex) {
+		const uint64_t key = Key(Cell(p.x), Cell(p.y), Cell(p.z));
+		const size_t slot = Slot(key);
+		keys[slot] = key;
+		next[vertex] = heads[slot];
+		heads[slot] = vertex;
+	}
+
+private:
+
+	int64_t Cell(float v) const {
+		// clamped, so tiny cells far from the origin don't overflow
+		const double c = std::floor(v / size);
+		return static_cast<int64_t>(std::max(-4.0e18, std::min(4.0e18, c)));
+	}
+
+	// cells which share a key are searched together, which is slower but still correct
+	static uint64_t Key(int64_t x, int64_t y, int64_t z) {
+		return static_cast<uint64_t>(x) * 73856093u ^ static_cast<uint64_t>(y) * 19349663u ^ static_cast<uint64_t>(z) * 83492791u;
+	}
+
+	// the slot holding the cell with key, or the empty slot where it goes; there are at least
+	// twice as many slots as vertices, so there always is one
+	size_t Slot(uint64_t key) const {
+		const size_t mask = keys.size() - 1;
+		size_t slot = static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> shift);
+		while (heads[slot] != NONE && keys[slot] != key) {
+			slot = (slot + 1) & mask;
+		}
+		return slot;
+	}
+
+	float epsilon;
+	double size;
+	unsigned int shift;
+	std::vector<uint64_t> keys;
+	std::vector<unsigned int> heads; // the last vertex inserted into every cell, NONE for empty slots
+	std::vector<unsigned int> next; // the vertex inserted into the same cell before
+};
+
+// ------------------------------------------------------------------------------------------------
+// Bone weights of every vertex, ordered by bone
+class VertexWeights
+{
+public:
+
+	explicit VertexWeights(const aiMesh& mesh) : first(mesh.mNumVertices + 1, 0) {
+		for (unsigned int b = 0; b < mesh.mNumBones; ++b) {
+			const aiBone& bone = *mesh.mBones[b];
+			for (unsigned int w = 0; w < bone.mNumWeights; ++w) {
+				++first[bone.mWeights[w].mVertexId + 1];
+			}
+		}
+		for (unsigned int v = 0; v < mesh.mNumVertices; ++v) {
+			first[v + 1] += first[v];
+		}
+		std::vector<unsigned int> end(first.begin(), first.end() - 1);
+		weights.resize(first.back());
+		for (unsigned int b = 0; b < mesh.mNumBones; ++b) {
+			const aiBone& bone = *mesh.mBones[b];
+			for (unsigned int w = 0; w < bone.mNumWeights; ++w) {
+				weights[end[bone.mWeights[w].mVertexId]++] = std::make_pair(b, bone.mWeights[w].mWeight);
+			}
+		}
+	}
+
+	bool Same(unsigned int a, unsigned int b) const {
+		return first[a + 1] - first[a] == first[b + 1] - first[b] &&
+			std::equal(weights.begin() + first[a], weights.begin() + first[a + 1], weights.begin() + first[b]);
+	}
+
+private:
+	std::vector<unsigned int> first; // weights of vertex v are weights[first[v]] to weights[first[v + 1]]
+	std::vector<std::pair<unsigned int, float> > weights;
+};
+
+// ------------------------------------------------------------------------------------------------
+inline bool IsFinite(const aiVector3D& v)
+{
+	return std::isfinite(v.x) && std::isfinite(v.y) && std::isfinite(v.z);
+}
+
+inline bool WithinAngle(const aiVector3D& a, const aiVector3D& b, float cosAngle)
+{
+	return a * b >= cosAngle * std::sqrt(a.SquareLength() * b.SquareLength());
+}
+
+inline bool WithinEpsilon(const aiVector3D& a, const aiVector3D& b, float epsilon)
+{
+	return std::fabs(a.x - b.x) <= epsilon && std::fabs(a.y - b.y) <= epsilon && std::fabs(a.z - b.z) <= epsilon;
+}
+
+// ------------------------------------------------------------------------------------------------
+// Keeps the elements of an array at the given indices
+template <typename T>
+void Compact(T*& data, const std::vector<unsigned int>& kept)
+{
+	if (!data) {
+		return;
+	}
+	T* const out = new T[kept.size()];
+	for (unsigned int i = 0; i < kept.size(); ++i) {
+		out[i] = data[kept[i]];
+	}
+	delete[] data;
+	data = out;
+}
+
+// ------------------------------------------------------------------------------------------------
+bool IsDegenerate(const aiFace& face)
+{
+	if (face.mNumIndices == 2) {
+		return face.mIndices[0] == face.mIndices[1];
+	}
+	if (face.mNumIndices == 3) {
+		return face.mIndices[0] == face.mIndices[1] || face.mIndices[1] == face.mIndices[2] || face.mIndices[0] == face.mIndices[2];
+	}
+	return false;
+}
+
+} //
+
+// ------------------------------------------------------------------------------------------------
+void VertexWelder :: WeldMesh(aiMesh* pMesh)
+{
+	const unsigned int num = pMesh->mNumVertices;
+	const Bounds bounds = ComputeBounds(pMesh->mVertices, num);
+	const float epsilon = bounds.IsEmpty() ? 0.0f : POSITION_EPSILON * (bounds.max - bounds.min).Length();
+	if (!(epsilon > 0.0f) || !std::isfinite(epsilon)) {
+		return;
+	}
+
+	const float cosAngle = std::cos(NORMAL_ANGLE * AI_MATH_PI_F / 180.0f);
+	const VertexWeights weights(*pMesh);
+	const aiMesh& mesh = *pMesh;
+	const auto same = [&](unsigned int a, unsigned int b) -> bool {
+		if ((mesh.mVertices[a] - mesh.mVertices[b]).SquareLength() > epsilon * epsilon) {
+			return false;
+		}
+		if (mesh.mNormals && !WithinAngle(mesh.mNormals[a], mesh.mNormals[b], cosAngle)) {
+			return false;
+		}
+		if (mesh.mTangents && (!WithinAngle(mesh.mTangents[a], mesh.mTangents[b], cosAngle) ||
+			!WithinAngle(mesh.mBitangents[a], mesh.mBitangents[b], cosAngle))) {
+			return false;
+		}
+		for (unsigned int c = 0; mesh.HasTextureCoords(c); ++c) {
+			if (!WithinEpsilon(mesh.mTextureCoords[c][a], mesh.mTextureCoords[c][b], UV_EPSILON)) {
+				return false;
+			}
+		}
+		for (unsigned int c = 0; mesh.HasVertexColors(c); ++c) {
+			if (mesh.mColors[c][a] != mesh.mColors[c][b]) {
+				return false;
+			}
+		}
+		return weights.Same(a, b);
+	};
+
+	// every vertex is joined with the first earlier one it matches, or kept
+	SpatialHash hash(epsilon, num);
+	std::vector<unsigned int> remap(num), kept;
+	kept.reserve(num);
+	for (unsigned int v = 0; v < num; ++v) {
+		const aiVector3D& p = mesh.mVertices[v];
+		const bool finite = IsFinite(p);
+		unsigned int found = NONE;
+		if (finite) {
+			hash.Find(p, [&](unsigned int k) {
+				if (!same(k, v)) {
+					return false;
+				}
+				found = k;
+				return true;
+			});
+		}
+		if (found != NONE) {
+			remap[v] = remap[found];
+			continue;
+		}
+		remap[v] = static_cast<unsigned int>(kept.size());
+		kept.push_back(v);
+		if (finite) {
+			hash.Insert(p, v);
+		}
+	}
+	if (kept.size() == num) {
+		return;
+	}
+
+	pMesh->mNumVertices = static_cast<unsigned int>(kept.size());
+	Compact(pMesh->mVertices, kept);
+	Compact(pMesh->mNormals, kept);
+	Compact(pMesh->mTangents, kept);
+	Compact(pMesh->mBitangents, kept);
+	for (unsigned int c = 0; c < AI_MAX_NUMBER_OF_COLOR_SETS; ++c) {
+		Compact(pMesh->mColors[c], kept);
+	}
+	for (unsigned int c = 0; c < AI_MAX_NUMBER_OF_TEXTURECOORDS; ++c) {
+		Compact(pMesh->mTextureCoords[c], kept);
+	}
+
+	// the indices move over to the faces which remain, instead of being copied
+	unsigned int faces = 0;
+	for (unsigned int f = 0; f < pMesh->mNumFaces; ++f) {
+		aiFace& face = pMesh->mFaces[f];
+		for (unsigned int i = 0; i < face.mNumIndices; ++i) {
+			face.mIndices[i] = remap[face.mIndices[i]];
+		}
+		if (!IsDegenerate(face)) {
+			++faces;
+		}
+	}
+	if (faces != pMesh->mNumFaces) {
+		aiFace* const out = new aiFace[faces];
+		unsigned int n = 0;
+		for (unsigned int f = 0; f < pMesh->mNumFaces; ++f) {
+			aiFace& face = pMesh->mFaces[f];
+			if (IsDegenerate(face)) {
+				continue;
+			}
+			std::swap(out[n].mNumIndices, face.mNumIndices);
+			std::swap(out[n].mIndices, face.mIndices);
+			++n;
+		}
+		delete[] pMesh->mFaces;
+		pMesh->mFaces = out;
+		pMesh->mNumFaces = faces;
+	}
+
+	// joined vertices had the same weights as the one kept
+	for (unsigned int b = 0; b < pMesh->mNumBones; ++b) {
+		aiBone& bone = *pMesh->mBones[b];
+		unsigned int n = 0;
+		for (unsigned int w = 0; w < bone.mNumWeights; ++w) {
+			const unsigned int v = bone.mWeights[w].mVertexId;
+			if (kept[remap[v]] == v) {
+				bone.mWeights[n++] = aiVertexWeight(remap[v], bone.mWeights[w].mWeight);
+			}
+		}
+		bone.mNumWeights = n;
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+// Executes the welding step on the given scene.
+void VertexWelder :: Execute( aiScene* pScene)
+{
+	verticesBefore = verticesAfter = 0;
+	for (unsigned int i = 0; i < pScene->mNumMeshes; ++i) {
+		aiMesh* const mesh = pScene->mMeshes[i];
+		verticesBefore += mesh->mNumVertices;
+		if (POSITION_EPSILON > 0.0f && mesh->HasPositions() && !mesh->mNumAnimMeshes) {
+			WeldMesh(mesh);
+		}
+		verticesAfter += mesh->mNumVertices;
+	}
+
+	if (!Assimp::DefaultLogger::isNullLogger()) {
+		Assimp::DefaultLogger::get()->info("g3dj: welding reduced vertices from " +
+			std::to_string(verticesBefore) + " to " + std::to_string(verticesAfter));
+	}
+}
@@ -0,0 +1,103 @@
+/*
+Assimp2Libgdx
+Copyright (c) 2017, Eugene Wang
+
+Licensed under a 3-clause BSD license. See the LICENSE file for more information.
+*/
+
+#ifndef INCLUDED_VERTEX_WELDER
+#define INCLUDED_VERTEX_WELDER
+
+struct aiScene;
+struct aiMesh;
+
+// ---------------------------------------------------------------------------
+/** Joins vertices which are nearly identical, which JoinIdenticalVertices
+ *  misses as it only compares exactly.
+ *
+ *  Two vertices are joined if their positions are within the position
+ *  epsilon, their normals, tangents and bitangents within the angle, and
+ *  their texture coordinates within the uv epsilon. Colors and bone weights
+ *  must match exactly. Every vertex is compared with the first vertex of
+ *  each group only, so groups never grow further than the epsilons, and
+ *  that first vertex is the one kept. Candidates are found with a spatial
+ *  hash, so the step takes linear time.
+ *
+ *  Faces which become degenerate are removed. Meshes with morph targets
+ *  are left alone.
+ */
+class VertexWelder
+{
+
+public:
+
+	VertexWelder() : POSITION_EPSILON(0.0f), NORMAL_ANGLE(1.0f), UV_EPSILON(1e-5f),
+		verticesBefore(0), verticesAfter(0) {
+	}
+
+public:
+
+	// -------------------------------------------------------------------
+	/** Sets how far apart positions may be to be joined, relative to the
+	 * size of the mesh's bounding box. 0 disables the step. */
+	void SetPositionEpsilon(float e) {
+		POSITION_EPSILON = e;
+	}
+
+	float GetPositionEpsilon() const {
+		return POSITION_EPSILON;
+	}
+
+	// -------------------------------------------------------------------
+	/** Sets the largest angle between normals, tangents and bitangents
+	 * of vertices that are joined, in degrees. */
+	void SetNormalAngle(float a) {
+		NORMAL_ANGLE = a;
+	}
+
+	float GetNormalAngle() const {
+		return NORMAL_ANGLE;
+	}
+
+	// -------------------------------------------------------------------
+	/** Sets how far apart the texture coordinates of vertices that are
+	 * joined may be, in each component. */
+	void SetUVEpsilon(float e) {
+		UV_EPSILON = e;
+	}
+
+	float GetUVEpsilon() const {
+		return UV_EPSILON;
+	}
+
+public:
+
+	// -------------------------------------------------------------------
+	/** Executes the step on the given scene.
+	 * @param pScene The scene to work at.
+	 */
+	void Execute(aiScene* pScene);
+
+	// -------------------------------------------------------------------
+	/** Vertices of all meshes before and after the last Execute() */
+	unsigned int GetVerticesBefore() const {
+		return verticesBefore;
+	}
+
+	unsigned int GetVerticesAfter() const {
+		return verticesAfter;
+	}
+
+private:
+
+	void WeldMesh(aiMesh* pMesh);
+
+	float POSITION_EPSILON;
+	float NORMAL_ANGLE;
+	float UV_EPSILON;
+
+	unsigned int verticesBefore;
+	unsigned int verticesAfter;
+};
+
+#endif // INCLUDED_VERTEX_WELDER
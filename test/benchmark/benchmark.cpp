@@ -0,0 +1,177 @@
+/*
+Assimp2Libgdx
+Copyright (c) 2017, Eugene Wang
+
+Licensed under a 3-clause BSD license. See the LICENSE file for more information.
+*/
+
+#include "benchmark.h"
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+
+namespace {
+
+struct Registration
+{
+	const char* name;
+	BenchmarkFunction function;
+};
+
+std::vector<Registration>& Registry()
+{
+	static std::vector<Registration> registry;
+	return registry;
+}
+
+// ------------------------------------------------------------------------------------------------
+// Runs a benchmark with more and more iterations until it takes at least minTime
+BenchmarkState Run(BenchmarkFunction function, double minTime)
+{
+	unsigned long long iterations = 1;
+	for (;;) {
+		BenchmarkState state(iterations);
+		function(state);
+
+		const double seconds = state.GetSeconds();
+		if (seconds >= minTime || iterations >= 1000000000ull) {
+			return state;
+		}
+
+		// aim a bit above minTime, but never grow by more than 10x at once
+		double scale = seconds > 0 ? minTime * 1.4 / seconds : 10.0;
+		scale = std::max(2.0, std::min(10.0, scale));
+		iterations = static_cast<unsigned long long>(iterations * scale);
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+void PrintUsage()
+{
+	std::cout << "usage: a2l_benchmark [--filter=text] [--min_time=seconds] [--json]\n"
+		<< "  --filter=text     only run benchmarks whose name contains text\n"
+		<< "  --min_time=s      minimum time to spend on each benchmark (default 0.5)\n"
+		<< "  --json            print the results as json, for tracking them over time"
+		<< std::endl;
+}
+
+} // namespace
+
+// ------------------------------------------------------------------------------------------------
+BenchmarkState :: BenchmarkState(unsigned long long iterations)
+	: iterations(iterations), done(0), bytes(0), items(0), seconds(0), running(false)
+{
+}
+
+// ------------------------------------------------------------------------------------------------
+bool BenchmarkState :: KeepRunning()
+{
+	if (done == 0) {
+		ResumeTiming();
+	}
+	if (done < iterations) {
+		++done;
+		return true;
+	}
+	PauseTiming();
+	return false;
+}
+
+// ------------------------------------------------------------------------------------------------
+void BenchmarkState :: PauseTiming()
+{
+	if (running) {
+		seconds += std::chrono::duration<double>(Clock::now() - start).count();
+		running = false;
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+void BenchmarkState :: ResumeTiming()
+{
+	if (!running) {
+		start = Clock::now();
+		running = true;
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+bool RegisterBenchmark(const char* name, BenchmarkFunction function)
+{
+	Registration registration = { name, function };
+	Registry().push_back(registration);
+	return true;
+}
+
+// ------------------------------------------------------------------------------------------------
+int RunBenchmarks(int argc, char** argv)
+{
+	std::string filter;
+	double minTime = 0.5;
+	bool json = false;
+	for (int i = 1; i < argc; ++i) {
+		if (!strncmp(argv[i], "--filter=", 9)) {
+			filter = argv[i] + 9;
+		}
+		else if (!strncmp(argv[i], "--min_time=", 11)) {
+			minTime = atof(argv[i] + 11);
+		}
+		else if (!strcmp(argv[i], "--json")) {
+			json = true;
+		}
+		else {
+			PrintUsage();
+			return strcmp(argv[i], "--help") ? -1 : 0;
+		}
+	}
+
+	if (json) {
+		std::cout << "[";
+	}
+	else {
+		std::cout << std::left << std::setw(36) << "benchmark" << std::right
+			<< std::setw(12) << "iterations" << std::setw(14) << "ms/iter"
+			<< std::setw(12) << "MB/s" << std::setw(14) << "items/s" << "\n";
+	}
+
+	bool first = true;
+	const std::vector<Registration>& registry = Registry();
+	for (unsigned int i = 0; i < registry.size(); ++i) {
+		const std::string name = registry[i].name;
+		if (name.find(filter) == std::string::npos) {
+			continue;
+		}
+
+		const BenchmarkState state = Run(registry[i].function, minTime);
+		const double seconds = state.GetSeconds();
+		const double msPerIteration = seconds * 1000.0 / state.GetIterations();
+		const double mbPerSecond = seconds > 0 ? state.GetBytesProcessed() / seconds / (1024.0 * 1024.0) : 0;
+		const double itemsPerSecond = seconds > 0 ? state.GetItemsProcessed() / seconds : 0;
+
+		if (json) {
+			std::cout << (first ? "\n" : ",\n") << "\t{\"name\": \"" << name << "\""
+				<< ", \"iterations\": " << state.GetIterations()
+				<< ", \"msPerIteration\": " << msPerIteration
+				<< ", \"bytesPerSecond\": " << (seconds > 0 ? state.GetBytesProcessed() / seconds : 0)
+				<< ", \"itemsPerSecond\": " << itemsPerSecond << "}" << std::flush;
+		}
+		else {
+			std::cout << std::left << std::setw(36) << name << std::right << std::fixed
+				<< std::setw(12) << state.GetIterations()
+				<< std::setw(14) << std::setprecision(3) << msPerIteration
+				<< std::setw(12) << std::setprecision(1) << mbPerSecond
+				<< std::setw(14) << std::setprecision(0) << itemsPerSecond << std::endl;
+		}
+		first = false;
+	}
+
+	if (json) {
+		std::cout << "\n]" << std::endl;
+	}
+	return 0;
+}
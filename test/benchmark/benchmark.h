@@ -0,0 +1,98 @@
+/*
+Assimp2Libgdx
+Copyright (c) 2017, Eugene Wang
+
+Licensed under a 3-clause BSD license. See the LICENSE file for more information.
+*/
+
+#ifndef INCLUDED_BENCHMARK
+#define INCLUDED_BENCHMARK
+
+#include <chrono>
+
+// ----------------------------------------------------------------------------
+// A minimal benchmark harness modelled after Google Benchmark's interface,
+// so benchmarks read the same and could move over without changes:
+//
+//   void BM_Something(BenchmarkState& state) {
+//       while (state.KeepRunning()) {
+//           ...
+//       }
+//       state.SetBytesProcessed(...);
+//   }
+//   BENCHMARK(BM_Something);
+// ----------------------------------------------------------------------------
+
+class BenchmarkState
+{
+
+public:
+
+	explicit BenchmarkState(unsigned long long iterations);
+
+public:
+
+	// -------------------------------------------------------------------
+	/** Returns true as long as the body should run again. The clock
+	 * starts with the first call and stops when it returns false.
+	 */
+	bool KeepRunning();
+
+	// -------------------------------------------------------------------
+	/** Excludes per-iteration setup and teardown from the timing. */
+	void PauseTiming();
+	void ResumeTiming();
+
+	// -------------------------------------------------------------------
+	/** Totals over all iterations, used to report throughput. */
+	void SetBytesProcessed(unsigned long long bytes) {
+		this->bytes = bytes;
+	}
+
+	void SetItemsProcessed(unsigned long long items) {
+		this->items = items;
+	}
+
+	unsigned long long GetIterations() const {
+		return iterations;
+	}
+
+	unsigned long long GetBytesProcessed() const {
+		return bytes;
+	}
+
+	unsigned long long GetItemsProcessed() const {
+		return items;
+	}
+
+	double GetSeconds() const {
+		return seconds;
+	}
+
+private:
+
+	typedef std::chrono::steady_clock Clock;
+
+	unsigned long long iterations, done;
+	unsigned long long bytes, items;
+	double seconds;
+	bool running;
+	Clock::time_point start;
+};
+
+typedef void (*BenchmarkFunction)(BenchmarkState&);
+
+// ---------------------------------------------------------------------------
+/** Adds a benchmark to the suite, use BENCHMARK() rather than calling this. */
+bool RegisterBenchmark(const char* name, BenchmarkFunction function);
+
+// ---------------------------------------------------------------------------
+/** Runs all registered benchmarks, see --help for the arguments.
+ *  @return exit code for main()
+ */
+int RunBenchmarks(int argc, char** argv);
+
+#define BENCHMARK(function) \
+	static const bool function##_registered = RegisterBenchmark(#function, function)
+
+#endif // INCLUDED_BENCHMARK
@@ -0,0 +1,437 @@
+/*
+Assimp2Libgdx
+Copyright (c) 2017, Eugene Wang
+
+Licensed under a 3-clause BSD license. See the LICENSE file for more information.
+*/
+
+#include <assimp/Exporter.hpp>
+#include <assimp/IOStream.hpp>
+#include <assimp/cexport.h>
+#include <assimp/scene.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "benchmark.h"
+#include "scene_generator.h"
+#include "assimp2libgdx.h"
+#include "json_writer.h"
+#include "mesh_splitter.h"
+#include "lod_generator.h"
+#include "scene_flattener.h"
+#include "triangle_strips.h"
+#include "vertex_welder.h"
+#include "bounds.h"
+#include "mapped_io.h"
+
+namespace {
+
+// ------------------------------------------------------------------------------------------------
+// Discards everything written to it, so only the writer itself is measured
+class NullStream : public Assimp::IOStream
+{
+public:
+	NullStream() : written(0) {
+	}
+
+	size_t Read(void*, size_t, size_t) {
+		return 0;
+	}
+
+	size_t Write(const void*, size_t size, size_t count) {
+		written += size * count;
+		return count;
+	}
+
+	aiReturn Seek(size_t, aiOrigin) {
+		return aiReturn_FAILURE;
+	}
+
+	size_t Tell() const {
+		return written;
+	}
+
+	size_t FileSize() const {
+		return written;
+	}
+
+	void Flush() {
+	}
+
+	size_t written;
+};
+
+// ------------------------------------------------------------------------------------------------
+void BM_JSONWriter_Floats(BenchmarkState& state)
+{
+	const unsigned int count = 1 << 18;
+	unsigned long long bytes = 0;
+	while (state.KeepRunning()) {
+		NullStream stream;
+		{
+			JSONWriter out(stream, JSONWriter::Flag_WriteSpecialFloats);
+			out.StartArray();
+			for (unsigned int i = 0; i < count; ++i) {
+				out.SimpleValue(i * 0.001f);
+			}
+			out.EndArray();
+		}
+		bytes += stream.written;
+	}
+	state.SetBytesProcessed(bytes);
+	state.SetItemsProcessed(state.GetIterations() * count);
+}
+BENCHMARK(BM_JSONWriter_Floats);
+
+// ------------------------------------------------------------------------------------------------
+// The same floats as above, written in bulk as the vertex writer does
+void BM_JSONWriter_FloatsBulk(BenchmarkState& state)
+{
+	const unsigned int count = 1 << 18;
+	std::vector<float> values(count);
+	for (unsigned int i = 0; i < count; ++i) {
+		values[i] = i * 0.001f;
+	}
+	unsigned long long bytes = 0;
+	while (state.KeepRunning()) {
+		NullStream stream;
+		{
+			JSONWriter out(stream, JSONWriter::Flag_WriteSpecialFloats);
+			out.StartArray();
+			out.SimpleValues(values.data(), values.size());
+			out.EndArray();
+		}
+		bytes += stream.written;
+	}
+	state.SetBytesProcessed(bytes);
+	state.SetItemsProcessed(state.GetIterations() * count);
+}
+BENCHMARK(BM_JSONWriter_FloatsBulk);
+
+// ------------------------------------------------------------------------------------------------
+void BM_JSONWriter_Objects(BenchmarkState& state)
+{
+	const unsigned int count = 1 << 14;
+	unsigned long long bytes = 0;
+	while (state.KeepRunning()) {
+		NullStream stream;
+		{
+			JSONWriter out(stream);
+			out.StartArray();
+			for (unsigned int i = 0; i < count; ++i) {
+				out.StartObj();
+				out.Key("id");
+				out.SimpleValue(std::string("node") + std::to_string(i));
+				out.Key("index");
+				out.SimpleValue(i);
+				out.EndObj();
+			}
+			out.EndArray();
+		}
+		bytes += stream.written;
+	}
+	state.SetBytesProcessed(bytes);
+	state.SetItemsProcessed(state.GetIterations() * count);
+}
+BENCHMARK(BM_JSONWriter_Objects);
+
+// ------------------------------------------------------------------------------------------------
+// Splits a copy of scene in every iteration, copying is not timed
+void RunSplitter(BenchmarkState& state, const aiScene& scene, unsigned int boneLimit)
+{
+	while (state.KeepRunning()) {
+		state.PauseTiming();
+		aiScene* copy;
+		aiCopyScene(&scene, &copy);
+		state.ResumeTiming();
+
+		MeshSplitter splitter;
+		splitter.SetLimit(1 << 15);
+		splitter.SetBoneLimit(boneLimit);
+		splitter.Execute(copy);
+
+		state.PauseTiming();
+		aiFreeScene(copy);
+		state.ResumeTiming();
+	}
+	state.SetItemsProcessed(state.GetIterations() * scene.mMeshes[0]->mNumVertices);
+}
+
+// ------------------------------------------------------------------------------------------------
+void BM_MeshSplitter_LargeMesh(BenchmarkState& state)
+{
+	static const std::unique_ptr<aiScene> scene(GenerateLargeMesh(1 << 20));
+	RunSplitter(state, *scene, 0);
+}
+BENCHMARK(BM_MeshSplitter_LargeMesh);
+
+// ------------------------------------------------------------------------------------------------
+void BM_MeshSplitter_Skinned(BenchmarkState& state)
+{
+	static const std::unique_ptr<aiScene> scene(GenerateSkinnedMesh(1 << 16, 128, 4));
+	RunSplitter(state, *scene, 24);
+}
+BENCHMARK(BM_MeshSplitter_Skinned);
+
+// ------------------------------------------------------------------------------------------------
+// Generates four levels of detail for a copy of a mesh the size the splitter leaves
+void BM_LodGenerator_Mesh(BenchmarkState& state)
+{
+	static const std::unique_ptr<aiScene> scene(GenerateLargeMesh(1 << 15));
+	while (state.KeepRunning()) {
+		state.PauseTiming();
+		aiScene* copy;
+		aiCopyScene(scene.get(), &copy);
+		state.ResumeTiming();
+
+		LodGenerator lods;
+		lods.SetLevels(4);
+		lods.Execute(copy);
+
+		state.PauseTiming();
+		aiFreeScene(copy);
+		state.ResumeTiming();
+	}
+	state.SetItemsProcessed(state.GetIterations() * scene->mMeshes[0]->mNumFaces);
+}
+BENCHMARK(BM_LodGenerator_Mesh);
+
+// ------------------------------------------------------------------------------------------------
+// Collapses a copy of a deep static hierarchy into one node with one merged mesh
+void BM_SceneFlattener_DeepHierarchy(BenchmarkState& state)
+{
+	static const std::unique_ptr<aiScene> scene(GenerateDeepHierarchy(2048));
+	while (state.KeepRunning()) {
+		state.PauseTiming();
+		aiScene* copy;
+		aiCopyScene(scene.get(), &copy);
+		state.ResumeTiming();
+
+		SceneFlattener flattener;
+		flattener.Execute(copy);
+
+		state.PauseTiming();
+		aiFreeScene(copy);
+		state.ResumeTiming();
+	}
+	state.SetItemsProcessed(state.GetIterations() * 2048);
+}
+BENCHMARK(BM_SceneFlattener_DeepHierarchy);
+
+// ------------------------------------------------------------------------------------------------
+// Stripifies the triangles of a mesh the size the splitter leaves
+void BM_TriangleStrips_Mesh(BenchmarkState& state)
+{
+	static const std::unique_ptr<aiScene> scene(GenerateLargeMesh(1 << 15));
+	const aiMesh& mesh = *scene->mMeshes[0];
+	std::vector<unsigned int> triangles;
+	for (unsigned int i = 0; i < mesh.mNumFaces; ++i) {
+		triangles.insert(triangles.end(), mesh.mFaces[i].mIndices, mesh.mFaces[i].mIndices + mesh.mFaces[i].mNumIndices);
+	}
+
+	volatile size_t size;
+	while (state.KeepRunning()) {
+		size = GenerateTriangleStrip(triangles).size();
+	}
+	(void)size;
+	state.SetItemsProcessed(state.GetIterations() * mesh.mNumFaces);
+}
+BENCHMARK(BM_TriangleStrips_Mesh);
+
+// ------------------------------------------------------------------------------------------------
+// Welds a copy of a large mesh, which has no near duplicates, so this is the cost of the search
+void BM_VertexWelder_LargeMesh(BenchmarkState& state)
+{
+	static const std::unique_ptr<aiScene> scene(GenerateLargeMesh(1 << 20));
+	while (state.KeepRunning()) {
+		state.PauseTiming();
+		aiScene* copy;
+		aiCopyScene(scene.get(), &copy);
+		state.ResumeTiming();
+
+		VertexWelder welder;
+		welder.SetPositionEpsilon(1e-6f);
+		welder.Execute(copy);
+
+		state.PauseTiming();
+		aiFreeScene(copy);
+		state.ResumeTiming();
+	}
+	state.SetItemsProcessed(state.GetIterations() * scene->mMeshes[0]->mNumVertices);
+}
+BENCHMARK(BM_VertexWelder_LargeMesh);
+
+// ------------------------------------------------------------------------------------------------
+void BM_Bounds_LargeMesh(BenchmarkState& state)
+{
+	static const std::unique_ptr<aiScene> scene(GenerateLargeMesh(1 << 20));
+	const aiMesh& mesh = *scene->mMeshes[0];
+	// written to, so the computation can't be optimized away
+	volatile float radius;
+	while (state.KeepRunning()) {
+		radius = ComputeBounds(mesh.mVertices, mesh.mNumVertices).radius;
+	}
+	(void)radius;
+	state.SetBytesProcessed(state.GetIterations() * mesh.mNumVertices * sizeof(aiVector3D));
+	state.SetItemsProcessed(state.GetIterations() * mesh.mNumVertices);
+}
+BENCHMARK(BM_Bounds_LargeMesh);
+
+// ------------------------------------------------------------------------------------------------
+// Runs the complete export into memory, as assimp2libgdx does when writing to stdout
+void RunExport(BenchmarkState& state, const aiScene& scene)
+{
+	Assimp::Exporter exporter;
+	exporter.RegisterExporter(Assimp2Libgdx_desc);
+
+	unsigned long long bytes = 0;
+	while (state.KeepRunning()) {
+		const aiExportDataBlob* const blob = exporter.ExportToBlob(&scene, "g3dj");
+		if (blob) {
+			bytes += blob->size;
+		}
+		exporter.FreeBlob();
+	}
+	state.SetBytesProcessed(bytes);
+}
+
+// ------------------------------------------------------------------------------------------------
+void BM_Export_LargeMesh(BenchmarkState& state)
+{
+	static const std::unique_ptr<aiScene> scene(GenerateLargeMesh(1 << 18));
+	RunExport(state, *scene);
+}
+BENCHMARK(BM_Export_LargeMesh);
+
+// ------------------------------------------------------------------------------------------------
+void BM_Export_DeepHierarchy(BenchmarkState& state)
+{
+	static const std::unique_ptr<aiScene> scene(GenerateDeepHierarchy(2048));
+	RunExport(state, *scene);
+}
+BENCHMARK(BM_Export_DeepHierarchy);
+
+// ------------------------------------------------------------------------------------------------
+void BM_Export_ManyMeshes(BenchmarkState& state)
+{
+	static const std::unique_ptr<aiScene> scene(GenerateManyMeshes(4096, 64));
+	RunExport(state, *scene);
+}
+BENCHMARK(BM_Export_ManyMeshes);
+
+// ------------------------------------------------------------------------------------------------
+void BM_Export_Skinned(BenchmarkState& state)
+{
+	static const std::unique_ptr<aiScene> scene(GenerateSkinnedMesh(1 << 16, 128, 4));
+	RunExport(state, *scene);
+}
+BENCHMARK(BM_Export_Skinned);
+
+// ------------------------------------------------------------------------------------------------
+void BM_Export_LongAnimation(BenchmarkState& state)
+{
+	static const std::unique_ptr<aiScene> scene(GenerateLongAnimation(64, 4096));
+	RunExport(state, *scene);
+}
+BENCHMARK(BM_Export_LongAnimation);
+
+// ------------------------------------------------------------------------------------------------
+// Exports one scene from a thread per core at once through the library, as a server linking it
+// does; every iteration is one export per thread
+void BM_Export_Concurrent(BenchmarkState& state)
+{
+	static const std::unique_ptr<aiScene> scene(GenerateManyMeshes(256, 64));
+	const unsigned int threads = std::max(1u, std::thread::hardware_concurrency());
+	const Assimp2LibgdxOptions options;
+
+	unsigned long long bytes = 0;
+	while (state.KeepRunning()) {
+		std::vector<std::string> outputs(threads);
+		std::vector<std::thread> workers;
+		for (unsigned int i = 0; i < threads; ++i) {
+			workers.push_back(std::thread([&outputs, &options, i]() {
+				Assimp2LibgdxExportToBuffer(scene.get(), options, outputs[i]);
+			}));
+		}
+		for (unsigned int i = 0; i < threads; ++i) {
+			workers[i].join();
+			bytes += outputs[i].size();
+		}
+	}
+	state.SetBytesProcessed(bytes);
+	state.SetItemsProcessed(state.GetIterations() * threads);
+}
+BENCHMARK(BM_Export_Concurrent);
+
+// ------------------------------------------------------------------------------------------------
+// A 64 MB scratch file, removed again on exit
+const char* LargeInputFile()
+{
+	struct ScratchFile {
+		ScratchFile() : path("a2l_benchmark_input.bin") {
+			std::vector<char> block(1 << 20);
+			for (size_t i = 0; i < block.size(); ++i) {
+				block[i] = static_cast<char>(i * 2654435761u >> 24);
+			}
+			FILE* const file = fopen(path, "wb");
+			for (unsigned int i = 0; file && i < 64; ++i) {
+				fwrite(&block[0], 1, block.size(), file);
+			}
+			if (file) {
+				fclose(file);
+			}
+		}
+		~ScratchFile() {
+			remove(path);
+		}
+		const char* path;
+	};
+	static const ScratchFile file;
+	return file.path;
+}
+
+// ------------------------------------------------------------------------------------------------
+// Reads a whole file at once, which is what most importers do
+void RunRead(BenchmarkState& state, Assimp::IOSystem& io)
+{
+	const char* const path = LargeInputFile();
+	std::vector<char> buffer;
+	unsigned long long bytes = 0;
+	while (state.KeepRunning()) {
+		Assimp::IOStream* const stream = io.Open(path, "rb");
+		if (!stream) {
+			break;
+		}
+		buffer.resize(stream->FileSize());
+		bytes += stream->Read(&buffer[0], 1, buffer.size());
+		io.Close(stream);
+	}
+	state.SetBytesProcessed(bytes);
+}
+
+// ------------------------------------------------------------------------------------------------
+void BM_Read_Mapped(BenchmarkState& state)
+{
+	MappedIOSystem io(true);
+	RunRead(state, io);
+}
+BENCHMARK(BM_Read_Mapped);
+
+// ------------------------------------------------------------------------------------------------
+void BM_Read_Stdio(BenchmarkState& state)
+{
+	MappedIOSystem io(false);
+	RunRead(state, io);
+}
+BENCHMARK(BM_Read_Stdio);
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+	return RunBenchmarks(argc, argv);
+}
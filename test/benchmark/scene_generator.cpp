@@ -0,0 +1,267 @@
+/*
+Assimp2Libgdx
+Copyright (c) 2017, Eugene Wang
+
+Licensed under a 3-clause BSD license. See the LICENSE file for more information.
+*/
+
+#include "scene_generator.h"
+
+#include <assimp/scene.h>
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+namespace {
+
+// ------------------------------------------------------------------------------------------------
+// Triangulated grid of columns x rows quads in the xy plane
+aiMesh* GenerateGrid(const std::string& name, unsigned int columns, unsigned int rows, unsigned int material)
+{
+	aiMesh* const mesh = new aiMesh();
+	mesh->mName.Set(name);
+	mesh->mMaterialIndex = material;
+	mesh->mPrimitiveTypes = aiPrimitiveType_TRIANGLE;
+
+	mesh->mNumVertices = (columns + 1) * (rows + 1);
+	mesh->mVertices = new aiVector3D[mesh->mNumVertices];
+	mesh->mNormals = new aiVector3D[mesh->mNumVertices];
+	mesh->mTextureCoords[0] = new aiVector3D[mesh->mNumVertices];
+	mesh->mNumUVComponents[0] = 2;
+	for (unsigned int y = 0; y <= rows; ++y) {
+		for (unsigned int x = 0; x <= columns; ++x) {
+			const unsigned int i = y * (columns + 1) + x;
+			// a little relief, so the data does not compress into a handful of values
+			mesh->mVertices[i] = aiVector3D(static_cast<float>(x), static_cast<float>(y), std::sin(x * 0.37f) * std::cos(y * 0.21f));
+			mesh->mNormals[i] = aiVector3D(0.0f, 0.0f, 1.0f);
+			mesh->mTextureCoords[0][i] = aiVector3D(static_cast<float>(x) / columns, static_cast<float>(y) / rows, 0.0f);
+		}
+	}
+
+	mesh->mNumFaces = columns * rows * 2;
+	mesh->mFaces = new aiFace[mesh->mNumFaces];
+	unsigned int face = 0;
+	for (unsigned int y = 0; y < rows; ++y) {
+		for (unsigned int x = 0; x < columns; ++x) {
+			const unsigned int a = y * (columns + 1) + x, b = a + 1, c = a + columns + 1, d = c + 1;
+			const unsigned int triangles[2][3] = { { a, b, d }, { a, d, c } };
+			for (unsigned int t = 0; t < 2; ++t) {
+				aiFace& f = mesh->mFaces[face++];
+				f.mNumIndices = 3;
+				f.mIndices = new unsigned int[3];
+				std::copy(triangles[t], triangles[t] + 3, f.mIndices);
+			}
+		}
+	}
+	return mesh;
+}
+
+// ------------------------------------------------------------------------------------------------
+// Grid with at least the given number of vertices, as square as possible
+aiMesh* GenerateGrid(const std::string& name, unsigned int vertices, unsigned int material)
+{
+	const unsigned int side = std::max(2u, static_cast<unsigned int>(std::ceil(std::sqrt(static_cast<double>(vertices)))));
+	return GenerateGrid(name, side - 1, side - 1, material);
+}
+
+// ------------------------------------------------------------------------------------------------
+aiMaterial* GenerateMaterial(unsigned int index)
+{
+	aiMaterial* const material = new aiMaterial();
+	const aiColor3D diffuse(0.2f + 0.1f * (index % 8), 0.5f, 0.8f);
+	material->AddProperty(&diffuse, 1, AI_MATKEY_COLOR_DIFFUSE);
+	const float opacity = 1.0f;
+	material->AddProperty(&opacity, 1, AI_MATKEY_OPACITY);
+	return material;
+}
+
+// ------------------------------------------------------------------------------------------------
+void SetMeshes(aiScene* scene, const std::vector<aiMesh*>& meshes)
+{
+	scene->mNumMeshes = static_cast<unsigned int>(meshes.size());
+	scene->mMeshes = new aiMesh*[meshes.size()];
+	std::copy(meshes.begin(), meshes.end(), scene->mMeshes);
+}
+
+// ------------------------------------------------------------------------------------------------
+void SetMaterials(aiScene* scene, unsigned int count)
+{
+	scene->mNumMaterials = count;
+	scene->mMaterials = new aiMaterial*[count];
+	for (unsigned int i = 0; i < count; ++i) {
+		scene->mMaterials[i] = GenerateMaterial(i);
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+void SetChildren(aiNode* parent, const std::vector<aiNode*>& children)
+{
+	parent->mNumChildren = static_cast<unsigned int>(children.size());
+	parent->mChildren = new aiNode*[children.size()];
+	for (unsigned int i = 0; i < children.size(); ++i) {
+		parent->mChildren[i] = children[i];
+		children[i]->mParent = parent;
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+void SetMesh(aiNode* node, unsigned int mesh)
+{
+	node->mNumMeshes = 1;
+	node->mMeshes = new unsigned int[1];
+	node->mMeshes[0] = mesh;
+}
+
+// ------------------------------------------------------------------------------------------------
+// Chain of count nodes named <prefix><n> below parent, each offset from the last
+aiNode* GenerateChain(aiNode* parent, const std::string& prefix, unsigned int count, const aiVector3D& offset)
+{
+	aiNode* last = parent;
+	for (unsigned int i = 0; i < count; ++i) {
+		aiNode* const node = new aiNode(prefix + std::to_string(i));
+		aiMatrix4x4::Translation(offset, node->mTransformation);
+		SetChildren(last, std::vector<aiNode*>(1, node));
+		last = node;
+	}
+	return last;
+}
+
+} // namespace
+
+// ------------------------------------------------------------------------------------------------
+aiScene* GenerateLargeMesh(unsigned int vertices)
+{
+	aiScene* const scene = new aiScene();
+	SetMeshes(scene, std::vector<aiMesh*>(1, GenerateGrid("large", vertices, 0)));
+	SetMaterials(scene, 1);
+	scene->mRootNode = new aiNode("root");
+	SetMesh(scene->mRootNode, 0);
+	return scene;
+}
+
+// ------------------------------------------------------------------------------------------------
+aiScene* GenerateDeepHierarchy(unsigned int depth)
+{
+	aiScene* const scene = new aiScene();
+	SetMeshes(scene, std::vector<aiMesh*>(1, GenerateGrid("box", 2, 2, 0)));
+	SetMaterials(scene, 1);
+	scene->mRootNode = new aiNode("root");
+
+	aiNode* node = scene->mRootNode;
+	for (unsigned int i = 0; i < depth; ++i) {
+		aiNode* const child = new aiNode("node" + std::to_string(i));
+		aiMatrix4x4 rotation, translation;
+		aiMatrix4x4::RotationZ(0.1f, rotation);
+		aiMatrix4x4::Translation(aiVector3D(0.0f, 1.0f, 0.0f), translation);
+		child->mTransformation = translation * rotation;
+		SetMesh(child, 0);
+		SetChildren(node, std::vector<aiNode*>(1, child));
+		node = child;
+	}
+	return scene;
+}
+
+// ------------------------------------------------------------------------------------------------
+aiScene* GenerateManyMeshes(unsigned int meshes, unsigned int verticesPerMesh)
+{
+	const unsigned int materials = 8;
+
+	aiScene* const scene = new aiScene();
+	std::vector<aiMesh*> generated(meshes);
+	std::vector<aiNode*> nodes(meshes);
+	for (unsigned int i = 0; i < meshes; ++i) {
+		generated[i] = GenerateGrid("mesh" + std::to_string(i), verticesPerMesh, i % materials);
+		nodes[i] = new aiNode("node" + std::to_string(i));
+		aiMatrix4x4::Translation(aiVector3D(static_cast<float>(i % 64) * 10.0f, static_cast<float>(i / 64) * 10.0f, 0.0f), nodes[i]->mTransformation);
+		SetMesh(nodes[i], i);
+	}
+	SetMeshes(scene, generated);
+	SetMaterials(scene, materials);
+	scene->mRootNode = new aiNode("root");
+	SetChildren(scene->mRootNode, nodes);
+	return scene;
+}
+
+// ------------------------------------------------------------------------------------------------
+aiScene* GenerateSkinnedMesh(unsigned int vertices, unsigned int bones, unsigned int weightsPerVertex)
+{
+	bones = std::max(1u, bones);
+	weightsPerVertex = std::max(1u, std::min(std::min(4u, weightsPerVertex), bones));
+
+	aiScene* const scene = GenerateLargeMesh(vertices);
+	aiMesh* const mesh = scene->mMeshes[0];
+	mesh->mName.Set("skinned");
+
+	// bones are laid out along x, each vertex is weighted to the bone of its
+	// column and the ones following it
+	float maxX = 0.0f;
+	for (unsigned int i = 0; i < mesh->mNumVertices; ++i) {
+		maxX = std::max(maxX, mesh->mVertices[i].x);
+	}
+
+	std::vector<std::vector<aiVertexWeight> > weights(bones);
+	for (unsigned int i = 0; i < mesh->mNumVertices; ++i) {
+		const unsigned int first = std::min(bones - weightsPerVertex, static_cast<unsigned int>(mesh->mVertices[i].x / (maxX + 1.0f) * bones));
+		for (unsigned int w = 0; w < weightsPerVertex; ++w) {
+			aiVertexWeight weight;
+			weight.mVertexId = i;
+			weight.mWeight = 1.0f / weightsPerVertex;
+			weights[first + w].push_back(weight);
+		}
+	}
+
+	mesh->mNumBones = bones;
+	mesh->mBones = new aiBone*[bones];
+	for (unsigned int b = 0; b < bones; ++b) {
+		aiBone* const bone = new aiBone();
+		bone->mName.Set("bone" + std::to_string(b));
+		aiMatrix4x4::Translation(aiVector3D(-(maxX + 1.0f) * (b + 1) / bones, 0.0f, 0.0f), bone->mOffsetMatrix);
+		bone->mNumWeights = static_cast<unsigned int>(weights[b].size());
+		bone->mWeights = new aiVertexWeight[bone->mNumWeights];
+		std::copy(weights[b].begin(), weights[b].end(), bone->mWeights);
+		mesh->mBones[b] = bone;
+	}
+
+	GenerateChain(scene->mRootNode, "bone", bones, aiVector3D((maxX + 1.0f) / bones, 0.0f, 0.0f));
+	return scene;
+}
+
+// ------------------------------------------------------------------------------------------------
+aiScene* GenerateLongAnimation(unsigned int channels, unsigned int keys)
+{
+	aiScene* const scene = new aiScene();
+	SetMeshes(scene, std::vector<aiMesh*>(1, GenerateGrid("box", 2, 2, 0)));
+	SetMaterials(scene, 1);
+	scene->mRootNode = new aiNode("root");
+	SetMesh(GenerateChain(scene->mRootNode, "joint", channels, aiVector3D(0.0f, 1.0f, 0.0f)), 0);
+
+	aiAnimation* const animation = new aiAnimation();
+	animation->mName.Set("long");
+	animation->mDuration = keys;
+	animation->mTicksPerSecond = 30.0;
+	animation->mNumChannels = channels;
+	animation->mChannels = new aiNodeAnim*[channels];
+	for (unsigned int c = 0; c < channels; ++c) {
+		aiNodeAnim* const channel = new aiNodeAnim();
+		channel->mNodeName.Set("joint" + std::to_string(c));
+		channel->mNumPositionKeys = channel->mNumRotationKeys = channel->mNumScalingKeys = keys;
+		channel->mPositionKeys = new aiVectorKey[keys];
+		channel->mRotationKeys = new aiQuatKey[keys];
+		channel->mScalingKeys = new aiVectorKey[keys];
+		for (unsigned int k = 0; k < keys; ++k) {
+			const float phase = k * 0.05f + c;
+			channel->mPositionKeys[k].mTime = channel->mRotationKeys[k].mTime = channel->mScalingKeys[k].mTime = k;
+			channel->mPositionKeys[k].mValue = aiVector3D(std::sin(phase), 1.0f, 0.0f);
+			channel->mRotationKeys[k].mValue = aiQuaternion(aiVector3D(0.0f, 0.0f, 1.0f), std::cos(phase));
+			channel->mScalingKeys[k].mValue = aiVector3D(1.0f, 1.0f + 0.1f * std::sin(phase), 1.0f);
+		}
+		animation->mChannels[c] = channel;
+	}
+
+	scene->mNumAnimations = 1;
+	scene->mAnimations = new aiAnimation*[1];
+	scene->mAnimations[0] = animation;
+	return scene;
+}
@@ -0,0 +1,47 @@
+/*
+Assimp2Libgdx
+Copyright (c) 2017, Eugene Wang
+
+Licensed under a 3-clause BSD license. See the LICENSE file for more information.
+*/
+
+#ifndef INCLUDED_SCENE_GENERATOR
+#define INCLUDED_SCENE_GENERATOR
+
+struct aiScene;
+
+// ----------------------------------------------------------------------------
+// Synthetic scenes for benchmarking, each stressing one part of the
+// converter. All of them are deterministic and need no input files. The
+// caller owns the returned scene and releases it with delete.
+// ----------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------
+/** One triangulated grid mesh with normals and uvs, of at least the given
+ *  number of vertices. Large values exercise the mesh writer and splitter.
+ */
+aiScene* GenerateLargeMesh(unsigned int vertices);
+
+// ---------------------------------------------------------------------------
+/** A chain of depth nodes, each with its own transform and a reference to
+ *  the same small mesh.
+ */
+aiScene* GenerateDeepHierarchy(unsigned int depth);
+
+// ---------------------------------------------------------------------------
+/** Many small meshes, each with its own node and one of a few materials. */
+aiScene* GenerateManyMeshes(unsigned int meshes, unsigned int verticesPerMesh);
+
+// ---------------------------------------------------------------------------
+/** A grid mesh skinned to a chain of bones, with every vertex influenced
+ *  by weightsPerVertex (at most 4) neighbouring bones.
+ */
+aiScene* GenerateSkinnedMesh(unsigned int vertices, unsigned int bones, unsigned int weightsPerVertex);
+
+// ---------------------------------------------------------------------------
+/** A small mesh under a chain of channels nodes, animated by a single
+ *  animation with keys position, rotation and scaling keys per node.
+ */
+aiScene* GenerateLongAnimation(unsigned int channels, unsigned int keys);
+
+#endif // INCLUDED_SCENE_GENERATOR
@@ -0,0 +1,295 @@
+/*
+Assimp2Libgdx
+Copyright (c) 2017, Eugene Wang
+
+Licensed under a 3-clause BSD license. See the LICENSE file for more information.
+*/
+
+// ----------------------------------------------------------------------------
+// Checks of the behaviour of the converter's passes on generated scenes,
+// which need neither input models nor golden files. Run by ctest.
+//
+// Exit codes: 0 passed, 1 failed.
+// ----------------------------------------------------------------------------
+
+#include <assimp/scene.h>
+
+#include <iostream>
+#include <memory>
+#include <set>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "scene_generator.h"
+#include "lod_generator.h"
+#include "scene_flattener.h"
+#include "triangle_strips.h"
+#include "vertex_welder.h"
+
+namespace {
+
+unsigned int failures = 0;
+
+// ------------------------------------------------------------------------------------------------
+void Fail(const char* check, const std::string& what)
+{
+	std::cerr << check << ": " << what << std::endl;
+	++failures;
+}
+
+// ------------------------------------------------------------------------------------------------
+// Levels must be smaller than the level before, made of valid triangles and the mesh's vertices
+void CheckLodLevels()
+{
+	const char* const check = "lod levels";
+	std::unique_ptr<aiScene> scene(GenerateLargeMesh(1 << 12));
+	std::set<std::tuple<float, float, float> > positions;
+	for (unsigned int v = 0; v < scene->mMeshes[0]->mNumVertices; ++v) {
+		const aiVector3D& p = scene->mMeshes[0]->mVertices[v];
+		positions.insert(std::make_tuple(p.x, p.y, p.z));
+	}
+
+	LodGenerator lods;
+	lods.SetLevels(4);
+	lods.Execute(scene.get());
+
+	const std::vector<unsigned int>& levels = lods.GetLevels(0);
+	if (levels.empty() || levels.size() > 4) {
+		Fail(check, std::to_string(levels.size()) + " levels generated, asked for 4");
+	}
+	unsigned int faces = scene->mMeshes[0]->mNumFaces;
+	for (unsigned int l = 0; l < levels.size(); ++l) {
+		if (levels[l] >= scene->mNumMeshes) {
+			Fail(check, "level " + std::to_string(l) + " is no mesh of the scene");
+			continue;
+		}
+		const aiMesh& level = *scene->mMeshes[levels[l]];
+		for (unsigned int v = 0; v < level.mNumVertices; ++v) {
+			const aiVector3D& p = level.mVertices[v];
+			if (!positions.count(std::make_tuple(p.x, p.y, p.z))) {
+				Fail(check, "level " + std::to_string(l) + " has a vertex which isn't one of its mesh");
+				break;
+			}
+		}
+		if (!level.mNumFaces || level.mNumFaces >= faces) {
+			Fail(check, "level " + std::to_string(l) + " has " + std::to_string(level.mNumFaces) + " faces, after "
+				+ std::to_string(faces));
+		}
+		faces = level.mNumFaces;
+		for (unsigned int f = 0; f < level.mNumFaces; ++f) {
+			const aiFace& face = level.mFaces[f];
+			bool valid = face.mNumIndices == 3;
+			for (unsigned int i = 0; valid && i < 3; ++i) {
+				valid = face.mIndices[i] < level.mNumVertices && face.mIndices[i] != face.mIndices[(i + 1) % 3];
+			}
+			if (!valid) {
+				Fail(check, "level " + std::to_string(l) + " has an invalid face " + std::to_string(f));
+				break;
+			}
+		}
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+// Rounds which can't drop any triangles end the generation, instead of being repeated forever
+void CheckLodWithoutProgress()
+{
+	const char* const check = "lod without progress";
+	std::unique_ptr<aiScene> scene(GenerateLargeMesh(1 << 8));
+	const unsigned int meshes = scene->mNumMeshes;
+
+	LodGenerator lods;
+	lods.SetLevels(4);
+	lods.SetRatio(1.0f);
+	lods.Execute(scene.get());
+
+	if (!lods.GetLevels(0).empty() || scene->mNumMeshes != meshes) {
+		Fail(check, "levels generated with a ratio of 1");
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+// Two static instances of a mesh, one of them mirrored, must be baked into the root with their
+// transforms, and the faces of the mirrored one must still face the way its normals point
+void CheckFlattenTransforms()
+{
+	const char* const check = "flatten transforms";
+	std::unique_ptr<aiScene> scene(GenerateLargeMesh(16));
+	const aiMesh& original = *scene->mMeshes[0];
+	std::vector<aiVector3D> vertices(original.mVertices, original.mVertices + original.mNumVertices);
+
+	aiMatrix4x4 rotation, translation, mirror;
+	aiMatrix4x4::RotationZ(0.5f, rotation);
+	aiMatrix4x4::Translation(aiVector3D(10.0f, 0.0f, 0.0f), translation);
+	aiMatrix4x4::Scaling(aiVector3D(-1.0f, 1.0f, 1.0f), mirror);
+	const aiMatrix4x4 transforms[2] = { translation * rotation, mirror * translation };
+
+	aiNode* const root = scene->mRootNode;
+	delete[] root->mMeshes;
+	root->mMeshes = nullptr;
+	root->mNumMeshes = 0;
+	root->mNumChildren = 2;
+	root->mChildren = new aiNode*[2];
+	for (unsigned int i = 0; i < 2; ++i) {
+		aiNode* const child = new aiNode("instance" + std::to_string(i));
+		child->mTransformation = transforms[i];
+		child->mNumMeshes = 1;
+		child->mMeshes = new unsigned int[1];
+		child->mMeshes[0] = 0;
+		child->mParent = root;
+		root->mChildren[i] = child;
+	}
+
+	SceneFlattener flattener;
+	flattener.Execute(scene.get());
+
+	if (root->mNumChildren) {
+		Fail(check, "static nodes are left below the root");
+	}
+	std::vector<aiVector3D> baked;
+	for (unsigned int m = 0; m < root->mNumMeshes; ++m) {
+		const aiMesh& mesh = *scene->mMeshes[root->mMeshes[m]];
+		baked.insert(baked.end(), mesh.mVertices, mesh.mVertices + mesh.mNumVertices);
+		for (unsigned int f = 0; f < mesh.mNumFaces; ++f) {
+			const unsigned int* const index = mesh.mFaces[f].mIndices;
+			const aiVector3D& a = mesh.mVertices[index[0]];
+			const aiVector3D normal = (mesh.mVertices[index[1]] - a) ^ (mesh.mVertices[index[2]] - a);
+			if (normal * mesh.mNormals[index[0]] <= 0) {
+				Fail(check, "face " + std::to_string(f) + " of mesh " + std::to_string(m) + " faces away from its normal");
+				break;
+			}
+		}
+	}
+	if (baked.size() != 2 * vertices.size()) {
+		Fail(check, std::to_string(baked.size()) + " vertices, expected " + std::to_string(2 * vertices.size()));
+	}
+	for (unsigned int i = 0; i < 2; ++i) {
+		for (unsigned int v = 0; v < vertices.size(); ++v) {
+			const aiVector3D expected = transforms[i] * vertices[v];
+			bool found = false;
+			for (unsigned int b = 0; !found && b < baked.size(); ++b) {
+				found = (baked[b] - expected).Length() < 1e-4f;
+			}
+			if (!found) {
+				Fail(check, "vertex " + std::to_string(v) + " of instance " + std::to_string(i) + " isn't transformed");
+				break;
+			}
+		}
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+// A triangle rotated so its smallest index comes first, which keeps its winding
+std::tuple<unsigned int, unsigned int, unsigned int> NormalizeTriangle(unsigned int a, unsigned int b, unsigned int c)
+{
+	if (b < a && b < c) {
+		return std::make_tuple(b, c, a);
+	}
+	if (c < a && c < b) {
+		return std::make_tuple(c, a, b);
+	}
+	return std::make_tuple(a, b, c);
+}
+
+// ------------------------------------------------------------------------------------------------
+// A strip must draw every triangle of the list exactly once, with its winding, and nothing else
+void CheckTriangleStrips()
+{
+	const char* const check = "triangle strips";
+	std::unique_ptr<aiScene> scene(GenerateLargeMesh(1 << 10));
+	const aiMesh& mesh = *scene->mMeshes[0];
+	std::vector<unsigned int> triangles;
+	for (unsigned int f = 0; f < mesh.mNumFaces; ++f) {
+		triangles.insert(triangles.end(), mesh.mFaces[f].mIndices, mesh.mFaces[f].mIndices + 3);
+	}
+	// a degenerate triangle, which is dropped, and triangles which share no edges
+	const unsigned int extra[] = { 0, 1, 1, 7, 3, 40, 9, 300, 200 };
+	triangles.insert(triangles.end(), extra, extra + sizeof(extra) / sizeof(extra[0]));
+
+	std::multiset<std::tuple<unsigned int, unsigned int, unsigned int> > expected, drawn;
+	for (unsigned int t = 0; t < triangles.size(); t += 3) {
+		const unsigned int* const index = &triangles[t];
+		if (index[0] != index[1] && index[1] != index[2] && index[2] != index[0]) {
+			expected.insert(NormalizeTriangle(index[0], index[1], index[2]));
+		}
+	}
+
+	const std::vector<unsigned int> strip = GenerateTriangleStrip(triangles);
+	for (unsigned int i = 0; i + 2 < strip.size(); ++i) {
+		const unsigned int a = strip[i], b = strip[i + 1], c = strip[i + 2];
+		if (a == b || b == c || c == a) {
+			continue;
+		}
+		// every other triangle of a strip is wound the other way around
+		drawn.insert(i % 2 ? NormalizeTriangle(b, a, c) : NormalizeTriangle(a, b, c));
+	}
+	if (drawn != expected) {
+		Fail(check, "the strip draws " + std::to_string(drawn.size()) + " triangles, not the "
+			+ std::to_string(expected.size()) + " of the list");
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+// A mesh exploded into a vertex per face corner, with noise on the positions, must weld back to
+// the vertices it was made of
+void CheckWeldExploded()
+{
+	const char* const check = "weld exploded";
+	std::unique_ptr<aiScene> scene(GenerateLargeMesh(1 << 10));
+	aiMesh& mesh = *scene->mMeshes[0];
+	const unsigned int vertices = mesh.mNumVertices;
+
+	const unsigned int corners = mesh.mNumFaces * 3;
+	aiVector3D* const positions = new aiVector3D[corners];
+	aiVector3D* const normals = new aiVector3D[corners];
+	aiVector3D* const uvs = new aiVector3D[corners];
+	for (unsigned int f = 0, k = 0; f < mesh.mNumFaces; ++f) {
+		for (unsigned int i = 0; i < 3; ++i, ++k) {
+			const unsigned int v = mesh.mFaces[f].mIndices[i];
+			const float noise = static_cast<float>(static_cast<int>(k * 7919 % 17) - 8) * 1e-6f;
+			positions[k] = mesh.mVertices[v] + aiVector3D(noise, -noise, noise);
+			normals[k] = mesh.mNormals[v];
+			uvs[k] = mesh.mTextureCoords[0][v];
+			mesh.mFaces[f].mIndices[i] = k;
+		}
+	}
+	delete[] mesh.mVertices;
+	delete[] mesh.mNormals;
+	delete[] mesh.mTextureCoords[0];
+	mesh.mVertices = positions;
+	mesh.mNormals = normals;
+	mesh.mTextureCoords[0] = uvs;
+	mesh.mNumVertices = corners;
+	const unsigned int faces = mesh.mNumFaces;
+
+	VertexWelder welder;
+	welder.SetPositionEpsilon(1e-5f);
+	welder.Execute(scene.get());
+
+	if (scene->mMeshes[0]->mNumVertices != vertices) {
+		Fail(check, std::to_string(corners) + " vertices welded to " + std::to_string(scene->mMeshes[0]->mNumVertices)
+			+ ", not " + std::to_string(vertices));
+	}
+	if (scene->mMeshes[0]->mNumFaces != faces) {
+		Fail(check, std::to_string(faces - scene->mMeshes[0]->mNumFaces) + " faces lost");
+	}
+}
+
+} // namespace
+
+// ------------------------------------------------------------------------------------------------
+int main()
+{
+	CheckLodLevels();
+	CheckLodWithoutProgress();
+	CheckFlattenTransforms();
+	CheckTriangleStrips();
+	CheckWeldExploded();
+
+	if (failures) {
+		std::cerr << failures << " checks failed" << std::endl;
+		return 1;
+	}
+	return 0;
+}
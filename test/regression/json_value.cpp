@@ -0,0 +1,320 @@
+/*
+Assimp2Libgdx
+Copyright (c) 2017, Eugene Wang
+
+Licensed under a 3-clause BSD license. See the LICENSE file for more information.
+*/
+
+#include "json_value.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <sstream>
+
+namespace {
+
+class Parser
+{
+public:
+	explicit Parser(const std::string& text) : text(text), pos(0) {
+	}
+
+	bool Parse(JsonValue& value, std::string& error) {
+		if (!Value(value) || (SkipSpace(), pos != text.size())) {
+			std::ostringstream s;
+			s << "malformed json at line " << Line() << ": " << (message.empty() ? "trailing characters" : message);
+			error = s.str();
+			return false;
+		}
+		return true;
+	}
+
+private:
+	bool Fail(const char* what) {
+		message = what;
+		return false;
+	}
+
+	unsigned int Line() const {
+		return 1 + static_cast<unsigned int>(std::count(text.begin(), text.begin() + std::min(pos, text.size()), '\n'));
+	}
+
+	void SkipSpace() {
+		while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\t' || text[pos] == '\n' || text[pos] == '\r')) {
+			++pos;
+		}
+	}
+
+	bool Literal(const char* word) {
+		const std::string::size_type length = std::char_traits<char>::length(word);
+		if (text.compare(pos, length, word) != 0) {
+			return Fail("unexpected character");
+		}
+		pos += length;
+		return true;
+	}
+
+	bool Value(JsonValue& value) {
+		SkipSpace();
+		if (pos >= text.size()) {
+			return Fail("unexpected end of input");
+		}
+		switch (text[pos])
+		{
+		case '{':
+			return ObjectValue(value);
+		case '[':
+			return ArrayValue(value);
+		case '\"':
+			value.type = JsonValue::String;
+			return StringValue(value.string);
+		case 't':
+			value.type = JsonValue::Boolean;
+			value.boolean = true;
+			return Literal("true");
+		case 'f':
+			value.type = JsonValue::Boolean;
+			value.boolean = false;
+			return Literal("false");
+		case 'n':
+			value.type = JsonValue::Null;
+			return Literal("null");
+		default:
+			return NumberValue(value);
+		}
+	}
+
+	bool ObjectValue(JsonValue& value) {
+		value.type = JsonValue::Object;
+		++pos;
+		SkipSpace();
+		if (pos < text.size() && text[pos] == '}') {
+			++pos;
+			return true;
+		}
+		for (;;) {
+			SkipSpace();
+			std::pair<std::string, JsonValue> member;
+			if (pos >= text.size() || text[pos] != '\"' || !StringValue(member.first)) {
+				return Fail("expected member name");
+			}
+			SkipSpace();
+			if (pos >= text.size() || text[pos] != ':') {
+				return Fail("expected ':'");
+			}
+			++pos;
+			if (!Value(member.second)) {
+				return false;
+			}
+			value.members.push_back(std::pair<std::string, JsonValue>());
+			value.members.back().first.swap(member.first);
+			std::swap(value.members.back().second, member.second);
+
+			SkipSpace();
+			if (pos < text.size() && text[pos] == ',') {
+				++pos;
+				continue;
+			}
+			if (pos < text.size() && text[pos] == '}') {
+				++pos;
+				return true;
+			}
+			return Fail("expected ',' or '}'");
+		}
+	}
+
+	bool ArrayValue(JsonValue& value) {
+		value.type = JsonValue::Array;
+		++pos;
+		SkipSpace();
+		if (pos < text.size() && text[pos] == ']') {
+			++pos;
+			return true;
+		}
+		for (;;) {
+			value.elements.push_back(JsonValue());
+			if (!Value(value.elements.back())) {
+				return false;
+			}
+			SkipSpace();
+			if (pos < text.size() && text[pos] == ',') {
+				++pos;
+				continue;
+			}
+			if (pos < text.size() && text[pos] == ']') {
+				++pos;
+				return true;
+			}
+			return Fail("expected ',' or ']'");
+		}
+	}
+
+	bool StringValue(std::string& out) {
+		++pos;
+		while (pos < text.size() && text[pos] != '\"') {
+			if (text[pos] == '\\' && pos + 1 < text.size()) {
+				// the exporter only escapes quotes and backslashes, keep other escapes as they are
+				const char c = text[pos + 1];
+				if (c == '\"' || c == '\\' || c == '\'' || c == '/') {
+					out.push_back(c);
+				}
+				else {
+					out.push_back('\\');
+					out.push_back(c);
+				}
+				pos += 2;
+				continue;
+			}
+			out.push_back(text[pos++]);
+		}
+		if (pos >= text.size()) {
+			return Fail("unterminated string");
+		}
+		++pos;
+		return true;
+	}
+
+	bool NumberValue(JsonValue& value) {
+		const char* const begin = text.c_str() + pos;
+		char* end;
+		value.type = JsonValue::Number;
+		value.number = strtod(begin, &end);
+		if (end == begin) {
+			return Fail("unexpected character");
+		}
+		pos += end - begin;
+		return true;
+	}
+
+private:
+	const std::string& text;
+	std::string::size_type pos;
+	std::string message;
+};
+
+// ------------------------------------------------------------------------------------------------
+const char* TypeName(JsonValue::Type type)
+{
+	static const char* const names[] = { "null", "boolean", "number", "string", "array", "object" };
+	return names[type];
+}
+
+// ------------------------------------------------------------------------------------------------
+class Comparer
+{
+public:
+	Comparer(double tolerance, std::vector<std::string>& differences, unsigned int maxDifferences)
+		: tolerance(tolerance), differences(differences), maxDifferences(maxDifferences) {
+	}
+
+	void Compare(const JsonValue& expected, const JsonValue& actual, const std::string& path) {
+		if (differences.size() >= maxDifferences) {
+			return;
+		}
+		if (expected.type != actual.type) {
+			Report(path, std::string("expected ") + TypeName(expected.type) + ", got " + TypeName(actual.type));
+			return;
+		}
+
+		std::ostringstream s;
+		switch (expected.type)
+		{
+		case JsonValue::Null:
+			break;
+		case JsonValue::Boolean:
+			if (expected.boolean != actual.boolean) {
+				Report(path, expected.boolean ? "expected true" : "expected false");
+			}
+			break;
+		case JsonValue::Number:
+			if (!NearlyEqual(expected.number, actual.number)) {
+				s.precision(9);
+				s << "expected " << expected.number << ", got " << actual.number;
+				Report(path, s.str());
+			}
+			break;
+		case JsonValue::String:
+			if (expected.string != actual.string) {
+				Report(path, "expected \"" + expected.string + "\", got \"" + actual.string + "\"");
+			}
+			break;
+		case JsonValue::Array:
+			if (expected.elements.size() != actual.elements.size()) {
+				s << "expected " << expected.elements.size() << " elements, got " << actual.elements.size();
+				Report(path, s.str());
+			}
+			for (size_t i = 0; i < std::min(expected.elements.size(), actual.elements.size()); ++i) {
+				std::ostringstream element;
+				element << path << "[" << i << "]";
+				Compare(expected.elements[i], actual.elements[i], element.str());
+			}
+			break;
+		case JsonValue::Object:
+			for (size_t i = 0; i < expected.members.size(); ++i) {
+				const std::string& name = expected.members[i].first;
+				const JsonValue* const other = actual.Find(name);
+				if (!other) {
+					Report(path, "missing member \"" + name + "\"");
+					continue;
+				}
+				Compare(expected.members[i].second, *other, path + "." + name);
+			}
+			for (size_t i = 0; i < actual.members.size(); ++i) {
+				if (!expected.Find(actual.members[i].first)) {
+					Report(path, "unexpected member \"" + actual.members[i].first + "\"");
+				}
+			}
+			break;
+		}
+	}
+
+private:
+	bool NearlyEqual(double a, double b) const {
+		if (a == b) {
+			return true;
+		}
+		const double scale = std::max(1.0, std::max(std::fabs(a), std::fabs(b)));
+		return std::fabs(a - b) <= tolerance * scale;
+	}
+
+	void Report(const std::string& path, const std::string& what) {
+		if (differences.size() < maxDifferences) {
+			differences.push_back((path.empty() ? std::string("(root)") : path) + ": " + what);
+		}
+	}
+
+	double tolerance;
+	std::vector<std::string>& differences;
+	unsigned int maxDifferences;
+};
+
+} // namespace
+
+// ------------------------------------------------------------------------------------------------
+const JsonValue* JsonValue :: Find(const std::string& name) const
+{
+	for (size_t i = 0; i < members.size(); ++i) {
+		if (members[i].first == name) {
+			return &members[i].second;
+		}
+	}
+	return nullptr;
+}
+
+// ------------------------------------------------------------------------------------------------
+bool ParseJson(const std::string& text, JsonValue& value, std::string& error)
+{
+	Parser parser(text);
+	return parser.Parse(value, error);
+}
+
+// ------------------------------------------------------------------------------------------------
+bool CompareJson(const JsonValue& expected, const JsonValue& actual, double tolerance,
+	std::vector<std::string>& differences, unsigned int maxDifferences)
+{
+	differences.clear();
+	Comparer comparer(tolerance, differences, maxDifferences);
+	comparer.Compare(expected, actual, "");
+	return differences.empty();
+}
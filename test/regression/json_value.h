@@ -0,0 +1,63 @@
+/*
+Assimp2Libgdx
+Copyright (c) 2017, Eugene Wang
+
+Licensed under a 3-clause BSD license. See the LICENSE file for more information.
+*/
+
+#ifndef INCLUDED_JSON_VALUE
+#define INCLUDED_JSON_VALUE
+
+#include <string>
+#include <vector>
+#include <utility>
+
+// ---------------------------------------------------------------------------
+/** Parsed json document, just enough to compare g3dj files with each other.
+ *  Object members keep their order, numbers are stored as double.
+ */
+struct JsonValue
+{
+	enum Type {
+		Null,
+		Boolean,
+		Number,
+		String,
+		Array,
+		Object
+	};
+
+	JsonValue() : type(Null), boolean(false), number(0) {
+	}
+
+	// -------------------------------------------------------------------
+	/** Returns the member called name, or nullptr if there is none. */
+	const JsonValue* Find(const std::string& name) const;
+
+	Type type;
+	bool boolean;
+	double number;
+	std::string string;
+	std::vector<JsonValue> elements;
+	std::vector<std::pair<std::string, JsonValue> > members;
+};
+
+// ---------------------------------------------------------------------------
+/** Parses a json document.
+ *  @return false on malformed input, in which case error says where
+ */
+bool ParseJson(const std::string& text, JsonValue& value, std::string& error);
+
+// ---------------------------------------------------------------------------
+/** Compares two documents. Object members are matched by name regardless
+ *  of their order, numbers are equal if they differ by no more than
+ *  tolerance, relative to the larger of the two for values above 1.
+ *  @param differences Receives one line per difference, with the json
+ *    path of where it was found
+ *  @param maxDifferences Stop after this many differences
+ *  @return true if the documents are equal
+ */
+bool CompareJson(const JsonValue& expected, const JsonValue& actual, double tolerance,
+	std::vector<std::string>& differences, unsigned int maxDifferences = 20);
+
+#endif // INCLUDED_JSON_VALUE
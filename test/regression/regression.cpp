@@ -0,0 +1,363 @@
+/*
+Assimp2Libgdx
+Copyright (c) 2017, Eugene Wang
+
+Licensed under a 3-clause BSD license. See the LICENSE file for more information.
+*/
+
+// ----------------------------------------------------------------------------
+// Converts one model with assimp2libgdx and checks the result against a
+// golden g3dj file, plus the conversion time and output size against a
+// baseline recorded along with it. Run by ctest, once per model.
+//
+// Instead of a model, one of the synthetic scenes of the benchmarks can be
+// exported through the converter library, which needs no input files.
+//
+// Exit codes: 0 passed, 1 failed, 77 skipped (model not available).
+// ----------------------------------------------------------------------------
+
+#include <assimp/scene.h>
+
+#include "json_value.h"
+#include "scene_generator.h"
+#include "assimp2libgdx.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+const int SkipReturnCode = 77;
+
+struct Options
+{
+	Options() : tolerance(1e-4), maxSlowdown(0.0), maxGrowth(5.0), runs(3), update(false) {
+	}
+
+	std::string converter, input, scene, golden, output, baseline, results, flags;
+	double tolerance;
+	double maxSlowdown; // percent, 0 only reports the time, as timings of other machines are no reference
+	double maxGrowth; // percent
+	unsigned int runs;
+	bool update;
+};
+
+// a baseline file holds "seconds <value>" and "bytes <value>" lines
+struct Baseline
+{
+	Baseline() : seconds(0), bytes(0) {
+	}
+
+	double seconds;
+	double bytes;
+};
+
+// ------------------------------------------------------------------------------------------------
+bool ReadFile(const std::string& path, std::string& data)
+{
+	std::ifstream file(path.c_str(), std::ios::binary);
+	if (!file) {
+		return false;
+	}
+	std::ostringstream s;
+	s << file.rdbuf();
+	data = s.str();
+	return true;
+}
+
+// ------------------------------------------------------------------------------------------------
+bool CopyFile(const std::string& from, const std::string& to)
+{
+	std::string data;
+	if (!ReadFile(from, data)) {
+		return false;
+	}
+	std::ofstream file(to.c_str(), std::ios::binary);
+	file << data;
+	return static_cast<bool>(file);
+}
+
+// ------------------------------------------------------------------------------------------------
+bool ReadBaseline(const std::string& path, Baseline& baseline)
+{
+	std::ifstream file(path.c_str());
+	if (!file) {
+		return false;
+	}
+	std::string line;
+	while (std::getline(file, line)) {
+		std::istringstream s(line);
+		std::string key;
+		double value;
+		if (!(s >> key >> value) || key[0] == '#') {
+			continue;
+		}
+		if (key == "seconds") {
+			baseline.seconds = value;
+		}
+		else if (key == "bytes") {
+			baseline.bytes = value;
+		}
+	}
+	return baseline.seconds > 0 || baseline.bytes > 0;
+}
+
+// ------------------------------------------------------------------------------------------------
+bool WriteBaseline(const std::string& path, const Baseline& baseline)
+{
+	std::ofstream file(path.c_str());
+	file << "# conversion baseline, written by a2l_regression --update\n"
+		<< "seconds " << baseline.seconds << "\n"
+		<< "bytes " << static_cast<unsigned long long>(baseline.bytes) << "\n";
+	return static_cast<bool>(file);
+}
+
+// ------------------------------------------------------------------------------------------------
+std::string Quote(const std::string& s)
+{
+	return "\"" + s + "\"";
+}
+
+// ------------------------------------------------------------------------------------------------
+// Runs the converter opts.runs times and returns the fastest wall time, or a
+// negative value if it failed
+double Convert(const Options& opts)
+{
+	const std::string command = Quote(opts.converter) + (opts.flags.empty() ? "" : " " + opts.flags)
+		+ " " + Quote(opts.input) + " " + Quote(opts.output);
+
+	double best = -1.0;
+	for (unsigned int i = 0; i < std::max(1u, opts.runs); ++i) {
+		const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		const int status = std::system(command.c_str());
+		const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		if (status != 0) {
+			std::cerr << "conversion failed (" << status << "): " << command << std::endl;
+			return -1.0;
+		}
+		best = best < 0 ? seconds : std::min(best, seconds);
+	}
+	return best;
+}
+
+// ------------------------------------------------------------------------------------------------
+// The synthetic scenes, small enough for their golden files to be reviewed
+aiScene* GenerateScene(const std::string& name)
+{
+	if (name == "large_mesh") {
+		return GenerateLargeMesh(256);
+	}
+	if (name == "deep_hierarchy") {
+		return GenerateDeepHierarchy(32);
+	}
+	if (name == "many_meshes") {
+		return GenerateManyMeshes(16, 16);
+	}
+	if (name == "skinned_mesh") {
+		return GenerateSkinnedMesh(256, 32, 4);
+	}
+	if (name == "long_animation") {
+		return GenerateLongAnimation(8, 16);
+	}
+	return nullptr;
+}
+
+// ------------------------------------------------------------------------------------------------
+// Exports the scene of opts.scene with the converter library, taking the options from the
+// flags, like Convert() does with the converter
+double ExportScene(const Options& opts)
+{
+	const std::unique_ptr<aiScene> scene(GenerateScene(opts.scene));
+	if (!scene) {
+		std::cerr << "unknown scene: " << opts.scene << std::endl;
+		return -1.0;
+	}
+
+	Assimp2LibgdxOptions options;
+	std::istringstream flags(opts.flags);
+	std::string flag;
+	while (flags >> flag) {
+		const std::string::size_type eq = flag.find('=');
+		const std::string name = flag.substr(0, eq);
+		std::string error = "unrecognized flag: " + flag;
+		if (name.compare(0, 2, "--") != 0
+			|| !options.SetFlag(name.substr(2), eq == std::string::npos ? std::string() : flag.substr(eq + 1), error)) {
+			std::cerr << error << std::endl;
+			return -1.0;
+		}
+	}
+
+	std::string json;
+	double best = -1.0;
+	for (unsigned int i = 0; i < std::max(1u, opts.runs); ++i) {
+		const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		try {
+			Assimp2LibgdxExportToBuffer(scene.get(), options, json);
+		}
+		catch (const std::exception& exc) {
+			std::cerr << "export failed: " << exc.what() << std::endl;
+			return -1.0;
+		}
+		const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		best = best < 0 ? seconds : std::min(best, seconds);
+	}
+
+	std::ofstream file(opts.output.c_str(), std::ios::binary);
+	file << json;
+	if (!file) {
+		std::cerr << "failure writing " << opts.output << std::endl;
+		return -1.0;
+	}
+	return best;
+}
+
+// ------------------------------------------------------------------------------------------------
+bool ParseOptions(int argc, char** argv, Options& opts)
+{
+	for (int i = 1; i < argc; ++i) {
+		const std::string arg = argv[i];
+		const std::string::size_type eq = arg.find('=');
+		const std::string name = arg.substr(0, eq);
+		const std::string value = eq == std::string::npos ? std::string() : arg.substr(eq + 1);
+
+		if (name == "--converter") opts.converter = value;
+		else if (name == "--input") opts.input = value;
+		else if (name == "--scene") opts.scene = value;
+		else if (name == "--golden") opts.golden = value;
+		else if (name == "--output") opts.output = value;
+		else if (name == "--baseline") opts.baseline = value;
+		else if (name == "--results") opts.results = value;
+		else if (name == "--flags") opts.flags = value;
+		else if (name == "--tolerance") opts.tolerance = atof(value.c_str());
+		else if (name == "--max-slowdown") opts.maxSlowdown = atof(value.c_str());
+		else if (name == "--max-growth") opts.maxGrowth = atof(value.c_str());
+		else if (name == "--runs") opts.runs = static_cast<unsigned int>(atoi(value.c_str()));
+		else if (name == "--update") opts.update = true;
+		else {
+			std::cerr << "unrecognized argument: " << arg << std::endl;
+			return false;
+		}
+	}
+	if ((opts.scene.empty() && (opts.converter.empty() || opts.input.empty())) || opts.golden.empty() || opts.output.empty()) {
+		std::cerr << "usage: a2l_regression (--converter=exe --input=model | --scene=name) --golden=g3dj --output=g3dj\n"
+			<< "         [--baseline=file] [--results=file] [--flags=converter flags] [--tolerance=x]\n"
+			<< "         [--max-slowdown=percent] [--max-growth=percent] [--runs=n] [--update]" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+	Options opts;
+	if (!ParseOptions(argc, argv, opts)) {
+		return 1;
+	}
+
+	if (opts.scene.empty() && !std::ifstream(opts.input.c_str())) {
+		std::cout << "model not available, skipping: " << opts.input << std::endl;
+		// so regression_update still updates everything else
+		return opts.update ? 0 : SkipReturnCode;
+	}
+
+	Baseline measured;
+	measured.seconds = opts.scene.empty() ? Convert(opts) : ExportScene(opts);
+	if (measured.seconds < 0) {
+		return 1;
+	}
+
+	std::string actualText;
+	if (!ReadFile(opts.output, actualText)) {
+		std::cerr << "no output written: " << opts.output << std::endl;
+		return 1;
+	}
+	measured.bytes = static_cast<double>(actualText.size());
+
+	const std::string& name = opts.scene.empty() ? opts.input : opts.scene;
+	std::cout << name << ": " << measured.seconds << " s, " << actualText.size() << " bytes" << std::endl;
+	if (!opts.results.empty()) {
+		std::ofstream results(opts.results.c_str());
+		results << "{\"input\": \"" << name << "\", \"seconds\": " << measured.seconds
+			<< ", \"bytes\": " << actualText.size() << "}\n";
+	}
+
+	if (opts.update) {
+		if (!CopyFile(opts.output, opts.golden) || (!opts.baseline.empty() && !WriteBaseline(opts.baseline, measured))) {
+			std::cerr << "failure updating " << opts.golden << std::endl;
+			return 1;
+		}
+		std::cout << "updated " << opts.golden << std::endl;
+		return 0;
+	}
+
+	bool passed = true;
+
+	// output must match the golden file, up to float noise
+	std::string goldenText, error;
+	JsonValue expected, actual;
+	if (!ReadFile(opts.golden, goldenText)) {
+		if (!opts.scene.empty()) {
+			std::cerr << "no golden file: " << opts.golden << " (create it with --update)" << std::endl;
+			return 1;
+		}
+		// goldens of models can only be written where the models are, by the regression_update target
+		std::cout << "no golden file, skipping: " << opts.golden << " (create it with --update)" << std::endl;
+		return SkipReturnCode;
+	}
+	if (!ParseJson(goldenText, expected, error)) {
+		std::cerr << opts.golden << ": " << error << std::endl;
+		return 1;
+	}
+	if (!ParseJson(actualText, actual, error)) {
+		std::cerr << opts.output << ": " << error << std::endl;
+		return 1;
+	}
+	std::vector<std::string> differences;
+	if (!CompareJson(expected, actual, opts.tolerance, differences)) {
+		std::cerr << "output differs from " << opts.golden << ":\n";
+		for (size_t i = 0; i < differences.size(); ++i) {
+			std::cerr << "  " << differences[i] << "\n";
+		}
+		passed = false;
+	}
+
+	// and must not have gotten much slower or bigger
+	Baseline baseline;
+	if (!opts.baseline.empty()) {
+		if (!ReadBaseline(opts.baseline, baseline)) {
+			std::cout << "no baseline in " << opts.baseline << ", not checking time and size" << std::endl;
+		}
+		else {
+			// time and size are checked independently, a baseline may hold only one of them
+			if (baseline.seconds > 0) {
+				const double slowdown = (measured.seconds / baseline.seconds - 1.0) * 100.0;
+				std::cout << "vs. baseline: " << (slowdown >= 0 ? "+" : "") << slowdown << "% time" << std::endl;
+				if (opts.maxSlowdown > 0 && slowdown > opts.maxSlowdown) {
+					std::cerr << "conversion got " << slowdown << "% slower, more than the allowed " << opts.maxSlowdown << "%" << std::endl;
+					passed = false;
+				}
+			}
+			if (baseline.bytes > 0) {
+				const double growth = (measured.bytes / baseline.bytes - 1.0) * 100.0;
+				std::cout << "vs. baseline: " << (growth >= 0 ? "+" : "") << growth << "% size" << std::endl;
+				if (growth > opts.maxGrowth) {
+					std::cerr << "output got " << growth << "% larger, more than the allowed " << opts.maxGrowth << "%" << std::endl;
+					passed = false;
+				}
+			}
+		}
+	}
+
+	return passed ? 0 : 1;
+}